@@ -23,7 +23,27 @@ arguments_parser::arguments_parser() :
 
             ("bs", bpo::value<int>(), "block size for scanning, range: [1, 10485760)")
 
-            ("a", bpo::value<std::string>(), "hash algo, range:crc16, crc32");
+            ("sfs", bpo::value<int>(), "max size of small files read at once, range: [0, 10485760]")
+
+            ("a", bpo::value<std::string>(), "hash algo, range:crc16, crc32")
+
+            ("cp", bpo::value<std::string>(), "page cache policy, range: normal, dontneed, direct")
+
+            ("bps", bpo::value<long long>(), "read limit in bytes per second, range: [1, ...)")
+
+            ("iops", bpo::value<int>(), "i/o operations limit per second, range: [1, ...)")
+
+            ("cf", bpo::value<bfs::path>(), "limits control file \"<bps> <iops>\", reread on SIGHUP")
+
+            ("idle", "run with idle i/o and cpu priority")
+
+            ("order", bpo::value<std::string>(), "order of groups processing, range: natural, largest, smallest")
+
+            ("deadline", bpo::value<int>(), "time budget in seconds, range: [1, ...)")
+
+            ("watch", bpo::value<bfs::path>(), "keep watching directories, answer queries on this unix socket")
+
+            ("cdc", bpo::value<int>(), "find partial duplicates with content defined chunks of this average size, power of 2, range: [1024, 1048576]");
 }
 
 arguments_parser::parse_result arguments_parser::parse(int argc, char **argv)
@@ -94,6 +114,18 @@ arguments_parser::parse_result arguments_parser::parse(int argc, char **argv)
             result.scanning_block_size = static_cast<size_t>(block_size);
         }
 
+        // optional parameter
+        if(_values_storage.count("sfs"))
+        {
+            int small_file_size = _values_storage["sfs"].as<int>();
+            if(small_file_size < 0)
+                throw wrong_args_exception("small file size can't have negative value");
+            else if(small_file_size > 1024 * 1024 * 10)
+                throw wrong_args_exception("small file size can't have value greater than 10 Mb");
+
+            result.scanning_small_file_size = static_cast<size_t>(small_file_size);
+        }
+
         // optional parameter
         if(_values_storage.count("a"))
         {
@@ -104,6 +136,91 @@ arguments_parser::parse_result arguments_parser::parse(int argc, char **argv)
             result.scanning_hash_algo = hash_algo;
         }
 
+        // optional parameter
+        if(_values_storage.count("cp"))
+        {
+            std::string policy = _values_storage["cp"].as<std::string>();
+            if(policy != "normal" && policy != "dontneed" && policy != "direct")
+                throw wrong_args_exception("wrong page cache policy");
+
+            result.scanning_cache_policy = policy;
+        }
+
+        // optional parameter
+        if(_values_storage.count("bps"))
+        {
+            long long bytes_per_sec = _values_storage["bps"].as<long long>();
+            if(bytes_per_sec < 1)
+                throw wrong_args_exception("read limit can't have value less than 1 byte per second");
+
+            result.limit_bytes_per_sec = static_cast<size_t>(bytes_per_sec);
+        }
+
+        // optional parameter
+        if(_values_storage.count("iops"))
+        {
+            int iops = _values_storage["iops"].as<int>();
+            if(iops < 1)
+                throw wrong_args_exception("i/o operations limit can't have value less than 1");
+
+            result.limit_iops = static_cast<size_t>(iops);
+        }
+
+        // optional parameter
+        if(_values_storage.count("cf"))
+        {
+            bfs::path control_file = _values_storage["cf"].as<bfs::path>();
+            if(control_file.is_relative())
+                control_file = bfs::absolute(control_file);
+
+            result.limit_control_file = control_file;
+        }
+
+        // optional parameter
+        result.idle_priority = _values_storage.count("idle") > 0;
+
+        // optional parameter
+        if(_values_storage.count("order"))
+        {
+            std::string order = _values_storage["order"].as<std::string>();
+            if(order != "natural" && order != "largest" && order != "smallest")
+                throw wrong_args_exception("wrong order of groups processing");
+
+            result.scanning_order = order;
+        }
+
+        // optional parameter
+        if(_values_storage.count("deadline"))
+        {
+            int deadline = _values_storage["deadline"].as<int>();
+            if(deadline < 1)
+                throw wrong_args_exception("time budget can't have value less than 1 second");
+
+            result.scanning_deadline = static_cast<size_t>(deadline);
+        }
+
+        // optional parameter
+        if(_values_storage.count("watch"))
+        {
+            bfs::path socket_path = _values_storage["watch"].as<bfs::path>();
+            if(socket_path.is_relative())
+                socket_path = bfs::absolute(socket_path);
+
+            result.watch_socket = socket_path;
+        }
+
+        // optional parameter
+        if(_values_storage.count("cdc"))
+        {
+            int avg_size = _values_storage["cdc"].as<int>();
+            if(avg_size < 1024 || avg_size > 1024 * 1024)
+                throw wrong_args_exception("average chunk size must be in range [1 Kb, 1 Mb]");
+            else if((avg_size & (avg_size - 1)) != 0)
+                throw wrong_args_exception("average chunk size must be a power of 2");
+
+            result.chunking_avg_size = static_cast<size_t>(avg_size);
+        }
+
         return result;
     }
     catch(const std::logic_error& ex) {
@@ -38,10 +38,50 @@ struct arguments {
      * @details Размер блока при чтении файла
      */
     std::optional<size_t> scanning_block_size;
+    /**
+     * @details Размер, до которого файл читается целиком за одно обращение
+     */
+    std::optional<size_t> scanning_small_file_size;
     /**
      * @details Алгоритм хеширования
      */
     std::optional<std::string> scanning_hash_algo;
+    /**
+     * @details Политика работы со страничным кешем при чтении
+     */
+    std::optional<std::string> scanning_cache_policy;
+    /**
+     * @details Ограничение чтения, байт в секунду
+     */
+    std::optional<size_t> limit_bytes_per_sec;
+    /**
+     * @details Ограничение операций ввода-вывода в секунду
+     */
+    std::optional<size_t> limit_iops;
+    /**
+     * @details Управляющий файл с лимитами, перечитывается по SIGHUP
+     */
+    std::optional<bfs::path> limit_control_file;
+    /**
+     * @details Работа с idle приоритетом ввода-вывода и CPU
+     */
+    bool idle_priority = false;
+    /**
+     * @details Порядок обработки групп файлов одинакового размера
+     */
+    std::optional<std::string> scanning_order;
+    /**
+     * @details Ограничение времени работы, секунды
+     */
+    std::optional<size_t> scanning_deadline;
+    /**
+     * @details Сокет для запросов в режиме непрерывного отслеживания
+     */
+    std::optional<bfs::path> watch_socket;
+    /**
+     * @details Средний размер блока в режиме поиска частичных дубликатов
+     */
+    std::optional<size_t> chunking_avg_size;
 };
 
 
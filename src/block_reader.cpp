@@ -0,0 +1,235 @@
+#include "block_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+cache_policy cache_policy_from_string(const std::optional<std::string>& policy)
+{
+    if(!policy.has_value())
+        return cache_policy::normal;
+
+    if(policy.value() == "dontneed")
+        return cache_policy::dontneed;
+    else if(policy.value() == "direct")
+        return cache_policy::direct;
+    else
+        return cache_policy::normal;
+}
+
+aligned_buffers_pool::aligned_buffers_pool(size_t buffer_size) :
+    _buffer_size(buffer_size)
+{
+}
+
+aligned_buffers_pool::~aligned_buffers_pool()
+{
+    for(char* ptr : _free)
+        std::free(ptr);
+}
+
+aligned_buffers_pool::buffer aligned_buffers_pool::acquire()
+{
+    char* ptr = nullptr;
+    if(!_free.empty())
+    {
+        ptr = _free.back();
+        _free.pop_back();
+    }
+    else
+    {
+        void* memory = nullptr;
+        if(posix_memalign(&memory, alignment, _buffer_size) != 0)
+            throw std::bad_alloc();
+        ptr = static_cast<char*>(memory);
+    }
+
+    return buffer(ptr, [this](char* released) {_free.push_back(released);});
+}
+
+size_t aligned_buffers_pool::buffer_size() const
+{
+    return _buffer_size;
+}
+
+block_reader::block_reader(const bfs::path& path, size_t block_size, cache_policy policy) :
+    _fd(-1), _offset(0), _file_size(0), _block_size(block_size), _policy(policy),
+    _current_extent(0)
+{
+    int flags = O_RDONLY | O_CLOEXEC;
+    if(_policy == cache_policy::direct)
+    {
+        _fd = ::open(path.c_str(), flags | O_DIRECT);
+        // не все файловые системы поддерживают O_DIRECT (например tmpfs),
+        // в этом случае хотя бы не оставляем прочитанное в кеше
+        if(_fd < 0 && errno == EINVAL)
+            _policy = cache_policy::dontneed;
+    }
+
+    if(_fd < 0)
+        _fd = ::open(path.c_str(), flags);
+
+    if(_fd >= 0)
+        map_extents();
+
+    if(_fd >= 0 && _policy == cache_policy::dontneed)
+    {
+        posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        posix_fadvise(_fd, 0, static_cast<off_t>(_block_size), POSIX_FADV_WILLNEED);
+    }
+}
+
+block_reader::~block_reader()
+{
+    close();
+}
+
+block_reader::block_reader(block_reader&& other) noexcept :
+    _fd(other._fd), _offset(other._offset), _file_size(other._file_size),
+    _block_size(other._block_size), _policy(other._policy),
+    _extents(std::move(other._extents)), _current_extent(other._current_extent)
+{
+    other._fd = -1;
+}
+
+block_reader& block_reader::operator=(block_reader&& other) noexcept
+{
+    if(this != &other)
+    {
+        close();
+        _fd = other._fd;
+        _offset = other._offset;
+        _file_size = other._file_size;
+        _block_size = other._block_size;
+        _policy = other._policy;
+        _extents = std::move(other._extents);
+        _current_extent = other._current_extent;
+        other._fd = -1;
+    }
+    return *this;
+}
+
+ssize_t block_reader::read(char* buffer)
+{
+    if(_fd < 0)
+        return -1;
+
+    if(_offset >= _file_size)
+        return 0;
+
+    while(_current_extent < _extents.size() && _extents[_current_extent].second <= _offset)
+        ++_current_extent;
+
+    if(next_is_hole())
+    {
+        size_t hole_size = std::min(_block_size, static_cast<size_t>(_file_size - _offset));
+        memset(buffer, 0, hole_size);
+        _offset += static_cast<off_t>(hole_size);
+        return static_cast<ssize_t>(hole_size);
+    }
+
+    ssize_t reading_result = pread_block(buffer);
+
+    // open принимает O_DIRECT, но чтение может отказать из-за выравнивания,
+    // тогда продолжаем без O_DIRECT, не оставляя прочитанное в кеше
+    if(reading_result < 0 && errno == EINVAL && _policy == cache_policy::direct)
+    {
+        int flags = fcntl(_fd, F_GETFL);
+        if(flags < 0 || fcntl(_fd, F_SETFL, flags & ~O_DIRECT) != 0)
+            return -1;
+
+        _policy = cache_policy::dontneed;
+        reading_result = pread_block(buffer);
+    }
+
+    if(reading_result <= 0)
+        return reading_result < 0 ? -1 : 0;
+
+    if(_policy == cache_policy::dontneed)
+    {
+        posix_fadvise(_fd, _offset, reading_result, POSIX_FADV_DONTNEED);
+        posix_fadvise(_fd, _offset + reading_result,
+                      static_cast<off_t>(_block_size), POSIX_FADV_WILLNEED);
+    }
+
+    _offset += reading_result;
+    return reading_result;
+}
+
+ssize_t block_reader::pread_block(char* buffer)
+{
+    ssize_t reading_result = 0;
+    do
+        reading_result = ::pread(_fd, buffer, _block_size, _offset);
+    while(reading_result < 0 && errno == EINTR);
+
+    return reading_result;
+}
+
+bool block_reader::next_is_hole() const
+{
+    if(_fd < 0 || _offset >= _file_size)
+        return false;
+
+    off_t block_end = _offset + static_cast<off_t>(_block_size);
+    size_t index = _current_extent;
+    while(index < _extents.size() && _extents[index].second <= _offset)
+        ++index;
+
+    return index == _extents.size() || _extents[index].first >= block_end;
+}
+
+bool block_reader::is_open() const
+{
+    return _fd >= 0;
+}
+
+void block_reader::map_extents()
+{
+    struct stat file_stat;
+    if(fstat(_fd, &file_stat) != 0)
+        return;
+    _file_size = file_stat.st_size;
+
+    off_t position = 0;
+    while(position < _file_size)
+    {
+        off_t data = lseek(_fd, position, SEEK_DATA);
+        if(data < 0)
+        {
+            // ENXIO - дальше до конца файла только дыра,
+            // иначе файловая система не умеет искать дыры
+            if(errno != ENXIO)
+            {
+                _extents.clear();
+                _extents.emplace_back(0, _file_size);
+            }
+            return;
+        }
+
+        off_t hole = lseek(_fd, data, SEEK_HOLE);
+        if(hole < 0)
+            hole = _file_size;
+
+        _extents.emplace_back(data, hole);
+        position = hole;
+    }
+}
+
+void block_reader::close()
+{
+    if(_fd < 0)
+        return;
+
+    if(_policy == cache_policy::dontneed)
+        posix_fadvise(_fd, 0, 0, POSIX_FADV_DONTNEED);
+
+    ::close(_fd);
+    _fd = -1;
+}
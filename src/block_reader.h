@@ -0,0 +1,165 @@
+#ifndef BLOCK_READER_H
+#define BLOCK_READER_H
+
+#include "common_aliases.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * @brief Политика работы со страничным кешем при чтении файлов
+ */
+enum class cache_policy {
+    /**
+     * @details Обычное чтение через страничный кеш
+     */
+    normal,
+    /**
+     * @details Последовательное чтение с упреждением на один блок
+     *  и сбросом прочитанных страниц из кеша после каждого блока
+     */
+    dontneed,
+    /**
+     * @details Чтение в обход страничного кеша (O_DIRECT)
+     */
+    direct
+};
+
+/**
+ * @brief Функция преобразования названия политики кеширования
+ * @arg policy - название политики
+ * @return Политика кеширования, по умолчанию normal
+ */
+cache_policy cache_policy_from_string(const std::optional<std::string>& policy);
+
+/**
+ * @brief Класс пула выровненных буферов для чтения
+ *  Буферы не освобождаются при возврате, а переиспользуются
+ */
+class aligned_buffers_pool
+{
+public:
+    using buffer = std::unique_ptr<char[], std::function<void(char*)>>;
+
+    /**
+     * @details Выравнивание буферов, подходящее для O_DIRECT
+     */
+    static constexpr size_t alignment = 4096;
+
+    /**
+     * @brief Конструктор
+     * @arg buffer_size - размер выдаваемых буферов
+     */
+    explicit aligned_buffers_pool(size_t buffer_size);
+
+    /**
+     * @brief Деструктор
+     */
+    ~aligned_buffers_pool();
+
+    aligned_buffers_pool(const aligned_buffers_pool&) = delete;
+    aligned_buffers_pool& operator=(const aligned_buffers_pool&) = delete;
+
+    /**
+     * @brief Метод получения буфера из пула
+     * @return Буфер, возвращающийся в пул при разрушении
+     */
+    buffer acquire();
+
+    /**
+     * @brief Метод получения размера буферов пула
+     * @return Размер буфера
+     */
+    size_t buffer_size() const;
+
+private:
+    size_t _buffer_size;
+    std::vector<char*> _free;
+};
+
+/**
+ * @brief Класс последовательного поблочного чтения файла
+ *  с учетом политики кеширования
+ *  Для разреженных файлов перед чтением строится карта данных
+ *  (SEEK_DATA/SEEK_HOLE), блоки целиком попадающие в дыры не читаются
+ */
+class block_reader
+{
+public:
+    /**
+     * @brief Конструктор
+     * @arg path - путь к файлу
+     * @arg block_size - размер блока
+     * @arg policy - политика кеширования
+     */
+    block_reader(const bfs::path& path, size_t block_size, cache_policy policy);
+
+    /**
+     * @brief Деструктор
+     */
+    ~block_reader();
+
+    block_reader(block_reader&& other) noexcept;
+    block_reader& operator=(block_reader&& other) noexcept;
+
+    block_reader(const block_reader&) = delete;
+    block_reader& operator=(const block_reader&) = delete;
+
+    /**
+     * @brief Метод чтения очередного блока
+     * @arg buffer - буфер размером не меньше блока,
+     *  для O_DIRECT выровненный на aligned_buffers_pool::alignment
+     * @return Количество прочитанных байт, 0 в конце файла, -1 при ошибке чтения
+     */
+    ssize_t read(char* buffer);
+
+    /**
+     * @brief Метод проверки, попадает ли очередной блок целиком в дыру
+     * @return true, если блок состоит только из нулей и не будет читаться с диска
+     */
+    bool next_is_hole() const;
+
+    /**
+     * @brief Метод проверки, открыт ли файл
+     * @return true, если файл удалось открыть
+     */
+    bool is_open() const;
+
+private:
+    /**
+     * @brief Метод построения карты участков файла, содержащих данные
+     */
+    void map_extents();
+
+    /**
+     * @brief Метод чтения блока по текущему смещению с повтором при EINTR
+     * @arg buffer - буфер размером не меньше блока
+     * @return Результат pread
+     */
+    ssize_t pread_block(char* buffer);
+
+    /**
+     * @brief Метод закрытия файла со сбросом его страниц из кеша
+     */
+    void close();
+
+private:
+    int _fd;
+    off_t _offset;
+    off_t _file_size;
+    size_t _block_size;
+    cache_policy _policy;
+
+    /**
+     * @details Участки с данными [начало, конец), отсортированные по смещению
+     */
+    std::vector<std::pair<off_t, off_t>> _extents;
+    size_t _current_extent;
+};
+
+#endif // BLOCK_READER_H
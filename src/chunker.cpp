@@ -0,0 +1,141 @@
+#include "chunker.h"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+    /**
+     * @brief Функция генерации таблицы Gear хеша
+     *  Псевдослучайные значения получаются из splitmix64,
+     *  чтобы границы блоков не зависели от запуска
+     */
+    constexpr std::array<uint64_t, 256> make_gear_table()
+    {
+        std::array<uint64_t, 256> table = {};
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for(auto& value : table)
+        {
+            state += 0x9E3779B97F4A7C15ull;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            value = z ^ (z >> 31);
+        }
+        return table;
+    }
+
+    constexpr std::array<uint64_t, 256> gear_table = make_gear_table();
+
+    /**
+     * @brief Функция построения маски из старших бит
+     *  Старшие биты Gear хеша зависят от последних 64 байт,
+     *  младшие - только от нескольких последних
+     */
+    uint64_t high_bits_mask(size_t bits)
+    {
+        return bits == 0 ? 0 : ~uint64_t(0) << (64 - bits);
+    }
+
+    size_t log2(size_t value)
+    {
+        size_t result = 0;
+        while(value >>= 1)
+            ++result;
+        return result;
+    }
+}
+
+chunker::chunker(size_t avg_size) :
+    _min_size(avg_size / 4),
+    _avg_size(avg_size),
+    _max_size(avg_size * 8),
+    _fingerprint(0),
+    _length(0)
+{
+    // нормализация второго уровня: до среднего размера граница
+    // в 4 раза менее вероятна, после - в 4 раза более
+    size_t bits = log2(avg_size);
+    _mask_small = high_bits_mask(bits + 2);
+    _mask_large = high_bits_mask(bits > 2 ? bits - 2 : 0);
+}
+
+void chunker::feed(const char* data, size_t size, const chunk_handler& handler)
+{
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+    size_t start = 0;
+    while(start < size)
+    {
+        size_t cut = find_cut(bytes + start, size - start);
+        if(cut == 0)
+            break;
+
+        if(_pending.empty())
+            handler(std::string_view(data + start, cut));
+        else
+        {
+            _pending.insert(_pending.end(), data + start, data + start + cut);
+            handler(std::string_view(_pending.data(), _pending.size()));
+            _pending.clear();
+        }
+
+        start += cut;
+    }
+
+    _pending.insert(_pending.end(), data + start, data + size);
+}
+
+size_t chunker::find_cut(const unsigned char* data, size_t size)
+{
+    // состояние хранится в локальных переменных, иначе из-за алиасинга
+    // с данными компилятор перечитывает поля класса на каждом байте
+    uint64_t fingerprint = _fingerprint;
+    size_t base = _length;
+
+    auto bound = [base, size](size_t length) {
+        return std::min(size, length > base ? length - base : 0);
+    };
+
+    // первые _min_size байт блока границей быть не могут, хеш по ним не считается
+    size_t i = bound(_min_size);
+
+    size_t small_end = bound(_avg_size - 1);
+    for(; i < small_end; ++i)
+    {
+        fingerprint = (fingerprint << 1) + gear_table[data[i]];
+        if(!(fingerprint & _mask_small))
+            return reset(i + 1);
+    }
+
+    size_t large_end = bound(_max_size);
+    for(; i < large_end; ++i)
+    {
+        fingerprint = (fingerprint << 1) + gear_table[data[i]];
+        if(!(fingerprint & _mask_large))
+            return reset(i + 1);
+    }
+
+    if(base + large_end == _max_size)
+        return reset(large_end);
+
+    _fingerprint = fingerprint;
+    _length = base + size;
+    return 0;
+}
+
+size_t chunker::reset(size_t cut)
+{
+    _fingerprint = 0;
+    _length = 0;
+    return cut;
+}
+
+void chunker::finish(const chunk_handler& handler)
+{
+    if(!_pending.empty())
+        handler(std::string_view(_pending.data(), _pending.size()));
+
+    _pending.clear();
+    _length = 0;
+    _fingerprint = 0;
+}
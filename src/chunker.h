@@ -0,0 +1,72 @@
+#ifndef CHUNKER_H
+#define CHUNKER_H
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Класс разбиения потока данных на блоки, определяемые содержимым
+ *  Реализует FastCDC: скользящий Gear хеш, пропуск минимального размера блока
+ *  и нормализованное разбиение с двумя масками вокруг среднего размера.
+ *  Данные подаются порциями произвольного размера, блоки на границах порций
+ *  склеиваются во внутреннем буфере
+ */
+class chunker
+{
+public:
+    /**
+     * @brief Функтор, получающий очередной блок целиком
+     */
+    using chunk_handler = std::function<void(std::string_view)>;
+
+    /**
+     * @brief Конструктор
+     * @arg avg_size - средний размер блока, степень двойки
+     */
+    explicit chunker(size_t avg_size);
+
+    /**
+     * @brief Метод обработки очередной порции данных
+     * @arg data - данные
+     * @arg size - размер данных
+     * @arg handler - обработчик найденных блоков
+     */
+    void feed(const char* data, size_t size, const chunk_handler& handler);
+
+    /**
+     * @brief Метод завершения потока, отдает последний неполный блок
+     * @arg handler - обработчик блока
+     */
+    void finish(const chunk_handler& handler);
+
+private:
+    /**
+     * @brief Метод поиска границы текущего блока
+     * @arg data - данные
+     * @arg size - размер данных
+     * @return Смещение конца блока, либо 0, если граница в данных не найдена
+     */
+    size_t find_cut(const unsigned char* data, size_t size);
+
+    /**
+     * @brief Метод сброса состояния хеша после найденной границы
+     * @arg cut - смещение конца блока
+     * @return То же смещение
+     */
+    size_t reset(size_t cut);
+
+private:
+    size_t _min_size;
+    size_t _avg_size;
+    size_t _max_size;
+    uint64_t _mask_small;
+    uint64_t _mask_large;
+
+    uint64_t _fingerprint;
+    size_t _length;
+    std::vector<char> _pending;
+};
+
+#endif // CHUNKER_H
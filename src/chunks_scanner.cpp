@@ -0,0 +1,117 @@
+#include "chunks_scanner.h"
+
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
+
+namespace {
+    // файлы читаются крупно, чтобы блоки реже попадали на границу чтения
+    // и копировались в буфер склейки
+    constexpr size_t read_size = 1024 * 1024;
+
+    // список владельцев блока ограничен, чтобы блоки, которые есть почти
+    // в каждом файле (например нули), не давали квадратичного числа пар
+    constexpr size_t max_chunk_owners = 16;
+}
+
+size_t chunks_scanner::fingerprint_hash::operator()(const fingerprint& fp) const
+{
+    size_t result = fp.first;
+    boost::hash_combine(result, fp.second);
+    return result;
+}
+
+chunks_scanner::chunks_scanner(size_t avg_chunk_size,
+                               std::optional<std::string> cache_policy,
+                               std::shared_ptr<rate_limiter> limiter) :
+    _avg_chunk_size(avg_chunk_size),
+    _cache_policy(cache_policy_from_string(cache_policy)),
+    _limiter(limiter),
+    _buffers(read_size)
+{
+}
+
+chunks_report chunks_scanner::scan(const grouped_by_size& files)
+{
+    _chunks.clear();
+    _shared.clear();
+    _report = chunks_report();
+
+    std::vector<bfs::path> ids;
+    chunk_counts counts;
+    for(const auto& group : files)
+        for(const bfs::path& p : group.second)
+        {
+            // файл попадает в индекс только прочитанным целиком,
+            // иначе его начало исказило бы общие объемы
+            counts.clear();
+            if(!split_file(p, counts))
+            {
+                _report.unreadable.push_back(p);
+                continue;
+            }
+
+            ids.push_back(p);
+            index_file(ids.size() - 1, counts);
+        }
+
+    for(const auto& elem : _shared)
+        _report.shared.push_back({ids[elem.first.first], ids[elem.first.second], elem.second});
+
+    std::stable_sort(_report.shared.begin(), _report.shared.end(), [](const auto& l, const auto& r)
+    {return l.shared_bytes > r.shared_bytes;});
+
+    return std::move(_report);
+}
+
+bool chunks_scanner::split_file(const bfs::path& path, chunk_counts& counts)
+{
+    block_reader reader(path, read_size, _cache_policy);
+    if(!reader.is_open())
+        return false;
+
+    chunker splitter(_avg_chunk_size);
+    auto handler = [&counts](std::string_view chunk) {
+        ++counts[fingerprint(std::hash<std::string_view>()(chunk), chunk.size())];
+    };
+
+    auto buffer = _buffers.acquire();
+    ssize_t reading_result = static_cast<ssize_t>(read_size);
+    while(reading_result == static_cast<ssize_t>(read_size))
+    {
+        if(!reader.next_is_hole())
+            _limiter->acquire(read_size);
+
+        reading_result = reader.read(buffer.get());
+        if(reading_result < 0)
+            return false;
+
+        splitter.feed(buffer.get(), static_cast<size_t>(reading_result), handler);
+    }
+    splitter.finish(handler);
+
+    return true;
+}
+
+void chunks_scanner::index_file(size_t file_id, const chunk_counts& counts)
+{
+    for(const auto& elem : counts)
+    {
+        size_t length = elem.first.second;
+        size_t count = elem.second;
+        _report.total_bytes += length * count;
+
+        std::vector<chunk_owner>& owners = _chunks[elem.first];
+        // все вхождения кроме самого первого можно заменить ссылкой
+        _report.saved_bytes += length * (owners.empty() ? count - 1 : count);
+
+        // повторы блока внутри одного файла не должны умножать общий объем пары
+        for(const chunk_owner& owner : owners)
+            _shared[std::make_pair(owner.first, file_id)] += length * std::min(owner.second, count);
+
+        if(owners.size() < max_chunk_owners)
+            owners.emplace_back(file_id, count);
+        else
+            ++_report.untracked_owners;
+    }
+}
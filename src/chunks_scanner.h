@@ -0,0 +1,138 @@
+#ifndef CHUNKS_SCANNER_H
+#define CHUNKS_SCANNER_H
+
+#include "common_aliases.h"
+#include "block_reader.h"
+#include "chunker.h"
+#include "rate_limiter.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+/**
+ * @brief Структура содержащая результаты анализа частичных дубликатов
+ */
+struct chunks_report {
+    /**
+     * @brief Объем данных, общий для пары файлов
+     */
+    struct shared_pair {
+        /**
+         * @details Файл, просмотренный раньше
+         */
+        bfs::path first;
+        /**
+         * @details Файл, повторяющий блоки первого
+         */
+        bfs::path second;
+        /**
+         * @details Объем общих блоков в байтах: каждый блок учитывается
+         *  столько раз, сколько он встречается в том файле, где его меньше
+         */
+        size_t shared_bytes;
+    };
+
+    /**
+     * @details Пары файлов с общими блоками, по убыванию объема
+     */
+    std::vector<shared_pair> shared;
+    /**
+     * @details Общий объем просмотренных данных
+     */
+    size_t total_bytes = 0;
+    /**
+     * @details Объем, который можно сэкономить дедупликацией блоков
+     */
+    size_t saved_bytes = 0;
+    /**
+     * @details Количество пар (блок, файл), не попавших в индекс из-за ограничения
+     *  числа файлов на блок, пары с такими файлами могут быть неполными
+     */
+    size_t untracked_owners = 0;
+    /**
+     * @details Файлы, которые не удалось прочитать, в результатах не учтены
+     */
+    paths unreadable;
+};
+
+/**
+ * @brief Класс поиска частичных дубликатов через разбиение файлов
+ *  на блоки, определяемые содержимым, и индекс отпечатков блоков
+ */
+class chunks_scanner
+{
+public:
+    /**
+     * @brief Конструктор
+     * @arg avg_chunk_size - средний размер блока, степень двойки
+     * @arg cache_policy - название политики работы со страничным кешем
+     * @arg limiter - ограничитель интенсивности чтения
+     */
+    chunks_scanner(size_t avg_chunk_size,
+                   std::optional<std::string> cache_policy,
+                   std::shared_ptr<rate_limiter> limiter);
+
+    /**
+     * @brief Метод анализа файлов
+     * @arg files - файлы, сгруппированные по размеру
+     * @return Общие объемы между файлами и возможная экономия
+     */
+    chunks_report scan(const grouped_by_size& files);
+
+private:
+    /**
+     * @brief Отпечаток блока: хеш содержимого и длина
+     */
+    using fingerprint = std::pair<size_t, size_t>;
+
+    /**
+     * @brief Хеш функция отпечатка для индекса
+     */
+    struct fingerprint_hash {
+        size_t operator()(const fingerprint& fp) const;
+    };
+
+    /**
+     * @brief Количество вхождений каждого блока в файл
+     */
+    using chunk_counts = std::unordered_map<fingerprint, size_t, fingerprint_hash>;
+
+    /**
+     * @brief Владелец блока: номер файла и количество вхождений блока в него
+     */
+    using chunk_owner = std::pair<size_t, size_t>;
+
+    /**
+     * @brief Метод разбиения файла на блоки и подсчета их вхождений
+     * @arg path - путь к файлу
+     * @arg counts - количество вхождений каждого блока
+     * @return Удалось ли прочитать файл целиком
+     */
+    bool split_file(const bfs::path& path, chunk_counts& counts);
+
+    /**
+     * @brief Метод добавления блоков прочитанного файла в индекс
+     * @arg file_id - номер файла
+     * @arg counts - количество вхождений каждого блока
+     */
+    void index_file(size_t file_id, const chunk_counts& counts);
+
+    size_t _avg_chunk_size;
+    cache_policy _cache_policy;
+    std::shared_ptr<rate_limiter> _limiter;
+    aligned_buffers_pool _buffers;
+
+    /**
+     * @details Файлы, в которых встретился блок, в порядке просмотра
+     */
+    std::unordered_map<fingerprint, std::vector<chunk_owner>, fingerprint_hash> _chunks;
+    /**
+     * @details Общий объем для пар файлов (просмотренный раньше, повторяющий)
+     */
+    std::map<std::pair<size_t, size_t>, size_t> _shared;
+    chunks_report _report;
+};
+
+#endif // CHUNKS_SCANNER_H
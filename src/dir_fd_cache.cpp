@@ -0,0 +1,82 @@
+#include "dir_fd_cache.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+    // границы размера кеша, если ограничение на дескрипторы слишком мало или не задано
+    constexpr size_t min_cache_size = 16;
+    constexpr size_t max_cache_size = 16384;
+
+    size_t cache_size_from_rlimit()
+    {
+        rlimit limit;
+        if(getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+            return max_cache_size;
+
+        // остальные дескрипторы остаются для файлов, сокетов и inotify
+        size_t quarter = static_cast<size_t>(limit.rlim_cur / 4);
+        return std::clamp(quarter, min_cache_size, max_cache_size);
+    }
+}
+
+dir_fd_cache::dir_fd_cache() :
+    dir_fd_cache(cache_size_from_rlimit())
+{
+}
+
+dir_fd_cache::dir_fd_cache(size_t max_size) :
+    _max_size(max_size)
+{
+}
+
+dir_fd_cache::~dir_fd_cache()
+{
+    clear();
+}
+
+int dir_fd_cache::open_file(const bfs::path& path)
+{
+    int dir = dir_fd(path.parent_path());
+    if(dir < 0)
+        return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    return ::openat(dir, path.filename().c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+int dir_fd_cache::dir_fd(const bfs::path& dir)
+{
+    auto found_iter = _fds.find(dir.string());
+    if(found_iter != _fds.end())
+    {
+        _lru.splice(_lru.begin(), _lru, found_iter->second);
+        return found_iter->second->second;
+    }
+
+    // дескриптору нужен только поиск имен, O_PATH не проверяет права на чтение
+    int fd = ::open(dir.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if(fd < 0)
+        return fd;
+
+    if(_fds.size() >= _max_size)
+    {
+        ::close(_lru.back().second);
+        _fds.erase(_lru.back().first);
+        _lru.pop_back();
+    }
+
+    _lru.emplace_front(dir.string(), fd);
+    _fds[dir.string()] = _lru.begin();
+    return fd;
+}
+
+void dir_fd_cache::clear()
+{
+    for(const auto& elem : _lru)
+        ::close(elem.second);
+    _lru.clear();
+    _fds.clear();
+}
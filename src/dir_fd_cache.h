@@ -0,0 +1,71 @@
+#ifndef DIR_FD_CACHE_H
+#define DIR_FD_CACHE_H
+
+#include "common_aliases.h"
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Класс кеша дескрипторов директорий
+ *  Позволяет открывать файлы через openat относительно уже открытой
+ *  директории, не разбирая каждый раз полный путь.
+ *  Директории открываются с O_PATH, при переполнении закрывается
+ *  давно не использованная
+ */
+class dir_fd_cache
+{
+public:
+    /**
+     * @brief Конструктор
+     *  Размер кеша - четверть ограничения RLIMIT_NOFILE на открытые дескрипторы
+     */
+    dir_fd_cache();
+
+    /**
+     * @brief Конструктор
+     * @arg max_size - максимальное количество открытых директорий
+     */
+    explicit dir_fd_cache(size_t max_size);
+
+    /**
+     * @brief Деструктор
+     */
+    ~dir_fd_cache();
+
+    dir_fd_cache(const dir_fd_cache&) = delete;
+    dir_fd_cache& operator=(const dir_fd_cache&) = delete;
+
+    /**
+     * @brief Метод открытия файла на чтение относительно его директории
+     * @arg path - путь к файлу
+     * @return Дескриптор файла или -1 при ошибке
+     */
+    int open_file(const bfs::path& path);
+
+private:
+    using lru_list = std::list<std::pair<std::string, int>>;
+
+    /**
+     * @brief Метод получения дескриптора директории
+     * @arg dir - путь к директории
+     * @return Дескриптор директории или -1 при ошибке
+     */
+    int dir_fd(const bfs::path& dir);
+
+    /**
+     * @brief Метод закрытия всех закешированных директорий
+     */
+    void clear();
+
+private:
+    size_t _max_size;
+    /**
+     * @details Директории от недавно использованных к давно не использованным
+     */
+    lru_list _lru;
+    std::unordered_map<std::string, lru_list::iterator> _fds;
+};
+
+#endif // DIR_FD_CACHE_H
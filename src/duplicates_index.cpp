@@ -0,0 +1,121 @@
+#include "duplicates_index.h"
+
+duplicates_index::duplicates_index(duplicates_scanner& scanner, stop_predicate stopped) :
+    _scanner(scanner),
+    _stopped(stopped)
+{
+}
+
+void duplicates_index::add(const grouped_by_size& files)
+{
+    for(const auto& group : files)
+    {
+        for(const bfs::path& p : group.second)
+        {
+            remove(p);
+            _files[p] = file_info{group.first, std::optional<size_t>()};
+            _sizes[group.first].insert(p);
+        }
+
+        digest_group(group.first);
+    }
+}
+
+void duplicates_index::update(const bfs::path& path, size_t size)
+{
+    remove(path);
+
+    _files[path] = file_info{size, std::optional<size_t>()};
+    _sizes[size].insert(path);
+
+    digest_group(size);
+}
+
+void duplicates_index::remove(const bfs::path& path)
+{
+    auto iter = _files.find(path);
+    if(iter != _files.end())
+        erase(iter);
+}
+
+void duplicates_index::remove_tree(const bfs::path& dir)
+{
+    // пути сравниваются поэлементно, поэтому содержимое директории лежит
+    // одним диапазоном сразу за ней, а завершающий разделитель в префиксе
+    // отсекает соседние директории вида "dir_other"
+    std::string prefix = dir.string();
+    if(prefix.empty() || prefix.back() != bfs::path::preferred_separator)
+        prefix += bfs::path::preferred_separator;
+
+    auto iter = _files.lower_bound(dir);
+    if(iter != _files.end() && iter->first == dir)
+        iter = erase(iter);
+
+    while(iter != _files.end() && iter->first.string().compare(0, prefix.size(), prefix) == 0)
+        iter = erase(iter);
+}
+
+void duplicates_index::clear()
+{
+    _files.clear();
+    _sizes.clear();
+    _contents.clear();
+}
+
+std::vector<paths> duplicates_index::duplicates() const
+{
+    std::vector<paths> result;
+    for(const auto& group : _contents)
+        if(group.second.size() > 1)
+            result.emplace_back(group.second.begin(), group.second.end());
+
+    return result;
+}
+
+void duplicates_index::digest_group(size_t size)
+{
+    auto group_iter = _sizes.find(size);
+    if(group_iter == _sizes.end() || group_iter->second.size() < 2)
+        return;
+
+    for(const bfs::path& p : group_iter->second)
+    {
+        if(_stopped())
+            return;
+
+        file_info& info = _files[p];
+        if(info.digest.has_value())
+            continue;
+
+        info.digest = _scanner.digest(p);
+        if(info.digest.has_value())
+            _contents[content_key(size, info.digest.value())].insert(p);
+    }
+}
+
+duplicates_index::files_map::iterator duplicates_index::erase(files_map::iterator iter)
+{
+    const bfs::path& path = iter->first;
+    const file_info& info = iter->second;
+
+    if(info.digest.has_value())
+    {
+        auto content_iter = _contents.find(content_key(info.size, info.digest.value()));
+        if(content_iter != _contents.end())
+        {
+            content_iter->second.erase(path);
+            if(content_iter->second.empty())
+                _contents.erase(content_iter);
+        }
+    }
+
+    auto size_iter = _sizes.find(info.size);
+    if(size_iter != _sizes.end())
+    {
+        size_iter->second.erase(path);
+        if(size_iter->second.empty())
+            _sizes.erase(size_iter);
+    }
+
+    return _files.erase(iter);
+}
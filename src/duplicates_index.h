@@ -0,0 +1,105 @@
+#ifndef DUPLICATES_INDEX_H
+#define DUPLICATES_INDEX_H
+
+#include "common_aliases.h"
+#include "duplicates_scanner.h"
+
+#include <functional>
+#include <map>
+#include <optional>
+
+/**
+ * @brief Класс инкрементально поддерживаемого индекса дубликатов
+ *  Хранит группы файлов одинакового размера и хеши содержимого.
+ *  Хеш вычисляется только для файлов, у которых есть файлы того же размера,
+ *  и пересчитывается только для изменившихся файлов
+ */
+class duplicates_index
+{
+public:
+    using stop_predicate = std::function<bool()>;
+
+    /**
+     * @brief Конструктор
+     * @arg scanner - объект вычисления хешей содержимого файлов
+     * @arg stopped - функтор, сообщающий о необходимости прервать вычисление хешей
+     */
+    duplicates_index(duplicates_scanner& scanner, stop_predicate stopped);
+
+    /**
+     * @brief Метод добавления в индекс результатов сканирования
+     * @arg files - все файлы, сгруппированные по размеру
+     */
+    void add(const grouped_by_size& files);
+
+    /**
+     * @brief Метод обновления файла, который был создан, изменен или перемещен
+     * @arg path - путь к файлу
+     * @arg size - текущий размер файла
+     */
+    void update(const bfs::path& path, size_t size);
+
+    /**
+     * @brief Метод удаления файла из индекса
+     * @arg path - путь к файлу
+     */
+    void remove(const bfs::path& path);
+
+    /**
+     * @brief Метод удаления из индекса всех файлов директории и ее поддиректорий
+     * @arg dir - путь к директории
+     */
+    void remove_tree(const bfs::path& dir);
+
+    /**
+     * @brief Метод очистки индекса
+     */
+    void clear();
+
+    /**
+     * @brief Метод получения текущих групп дубликатов
+     * @return Группы дубликатов
+     */
+    std::vector<paths> duplicates() const;
+
+private:
+    /**
+     * @brief Информация о файле в индексе
+     */
+    struct file_info {
+        /**
+         * @details Размер файла
+         */
+        size_t size;
+        /**
+         * @details Хеш содержимого, если он был вычислен
+         */
+        std::optional<size_t> digest;
+    };
+
+    using files_map = std::map<bfs::path, file_info>;
+    using content_key = std::pair<size_t, size_t>;
+
+    /**
+     * @brief Метод вычисления недостающих хешей для группы файлов одного размера
+     * @arg size - размер файлов группы
+     */
+    void digest_group(size_t size);
+
+    /**
+     * @brief Метод удаления файла из индекса по итератору
+     * @arg iter - итератор на файл
+     * @return Итератор на следующий файл
+     */
+    files_map::iterator erase(files_map::iterator iter);
+
+private:
+    duplicates_scanner& _scanner;
+    stop_predicate _stopped;
+
+    files_map _files;
+    grouped_by_size _sizes;
+    std::map<content_key, uniq_paths> _contents;
+};
+
+#endif // DUPLICATES_INDEX_H
@@ -1,19 +1,46 @@
 #include "duplicates_scanner.h"
 
 #include <boost/crc.hpp>
+#include <boost/functional/hash.hpp>
 
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <unordered_map>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 duplicates_scanner::duplicates_scanner(
         std::optional<size_t> block_size,
-        std::optional<std::string> hash_algo)
+        std::optional<size_t> small_file_size,
+        std::optional<std::string> hash_algo,
+        std::optional<std::string> cache_policy,
+        std::shared_ptr<rate_limiter> limiter,
+        std::optional<std::string> order,
+        std::optional<time_point> deadline) :
+    _cache_policy(cache_policy_from_string(cache_policy)),
+    _limiter(limiter),
+    _scheduler(schedule_order_from_string(order), limiter),
+    _deadline(deadline)
 {
     if(block_size.has_value())
         _block_size = block_size.value();
     else
         _block_size = 4 * 1024;
 
+    // O_DIRECT требует чтения блоками, кратными выравниванию
+    if(_cache_policy == cache_policy::direct)
+    {
+        const size_t alignment = aligned_buffers_pool::alignment;
+        _block_size = (_block_size + alignment - 1) / alignment * alignment;
+    }
+    _buffers = std::make_unique<aligned_buffers_pool>(_block_size);
+
+    _small_file_size = small_file_size.value_or(_block_size);
+    // лишний байт позволяет заметить файлы, выросшие после сканирования
+    _small_files_arena.resize(_small_file_size + 1);
+
     if(hash_algo.has_value())
     {
         std::string hash_str = hash_algo.value();
@@ -24,22 +51,78 @@ duplicates_scanner::duplicates_scanner(
     }
     else
         _hash = hash_creator<boost::crc_32_type>();
+
+    auto zero_block = _buffers->acquire();
+    memset(zero_block.get(), 0, _block_size);
+    _zero_block_hash = _hash(zero_block.get(), _block_size);
 }
 
-std::vector<paths> duplicates_scanner::find(const grouped_by_size& files)
+find_result duplicates_scanner::find(const grouped_by_size& files)
 {
-    std::vector<paths> result;
+    find_result result;
+
+    for(const auto& group : _scheduler.schedule(files))
+    {
+        if(deadline_expired())
+        {
+            result.unfinished.emplace_back(group.files->begin(), group.files->end());
+            continue;
+        }
+
+        if(group.file_size <= _small_file_size)
+        {
+            paths unfinished;
+            auto summary = analyse_small_group(group.file_size, *group.files, unfinished);
+            result.duplicates.insert(result.duplicates.end(), summary.begin(), summary.end());
+            if(!unfinished.empty())
+                result.unfinished.push_back(unfinished);
+            continue;
+        }
 
-    for(const auto group : files)
+        bool finished = true;
+        auto summary = analyse_group(*group.files, finished);
+        if(!finished)
+            result.unfinished.push_back(summary);
+        else if(!summary.empty())
+            result.duplicates.push_back(summary);
+    }
+
+    return result;
+}
+
+std::optional<size_t> duplicates_scanner::digest(const bfs::path& path)
+{
+    block_reader reader(path, _block_size, _cache_policy);
+    if(!reader.is_open())
+        return std::optional<size_t>();
+
+    auto buffer = _buffers->acquire();
+    size_t result = 0;
+
+    ssize_t reading_result = static_cast<ssize_t>(_block_size);
+    while(reading_result == static_cast<ssize_t>(_block_size))
     {
-        auto summary = analyse_group(group.second);
-        if(!summary.empty())
-            result.push_back(summary);
+        memset(buffer.get(), 0, _block_size);
+
+        bool is_hole = reader.next_is_hole();
+        if(!is_hole)
+            _limiter->acquire(_block_size);
+
+        reading_result = reader.read(buffer.get());
+        if(reading_result < 0)
+            return std::optional<size_t>();
+
+        boost::hash_combine(result, is_hole ? _zero_block_hash : _hash(buffer.get(), _block_size));
     }
 
     return result;
 }
 
+bool duplicates_scanner::deadline_expired() const
+{
+    return _deadline.has_value() && std::chrono::steady_clock::now() >= _deadline.value();
+}
+
 template<typename T>
 duplicates_scanner::hash_function duplicates_scanner::hash_creator()
 {
@@ -50,33 +133,53 @@ duplicates_scanner::hash_function duplicates_scanner::hash_creator()
     };
 }
 
-paths duplicates_scanner::analyse_group(const uniq_paths& files_paths)
+paths duplicates_scanner::analyse_group(const uniq_paths& files_paths, bool& finished)
 {
     paths result;
-    std::unordered_map<std::string, std::pair<std::fstream, size_t>> hashes;
+    std::unordered_map<std::string, std::pair<block_reader, size_t>> hashes;
 
     for(const bfs::path& p : files_paths)
-    {
-        std::string path_str = p.string();
-        std::fstream read_stream(path_str, std::fstream::in);
-        hashes[path_str] = std::make_pair(std::move(read_stream), 0);
-    }
+        hashes.emplace(std::piecewise_construct,
+                       std::forward_as_tuple(p.string()),
+                       std::forward_as_tuple(block_reader(p, _block_size, _cache_policy), 0));
 
-    std::vector<char> buffer(_block_size);
+    auto buffer = _buffers->acquire();
 
     bool end_of_files = false;
     while(!hashes.empty() && !end_of_files)
     {
+        if(deadline_expired())
+        {
+            finished = false;
+            break;
+        }
+
+        std::vector<std::string> failed;
         for(auto& elem : hashes)
         {
-            memset(buffer.data(), 0, _block_size);
+            memset(buffer.get(), 0, _block_size);
             auto& value = elem.second;
 
-            auto reading_result = value.first.readsome(buffer.data(), _block_size);
+            // блок целиком в дыре разреженного файла не читается и не хешируется
+            bool is_hole = value.first.next_is_hole();
+            if(!is_hole)
+                _limiter->acquire(_block_size);
+
+            auto reading_result = value.first.read(buffer.get());
+            if(reading_result < 0)
+            {
+                // непрочитанный файл нельзя считать дубликатом
+                failed.push_back(elem.first);
+                continue;
+            }
+
             end_of_files = static_cast<size_t>(reading_result) < _block_size;
-            value.second = _hash(buffer.data(), buffer.size());
+            value.second = is_hole ? _zero_block_hash : _hash(buffer.get(), _block_size);
         }
 
+        for(const auto& path : failed)
+            hashes.erase(path);
+
         auto iter = hashes.begin();
         while(iter != hashes.end())
         {
@@ -98,3 +201,51 @@ paths duplicates_scanner::analyse_group(const uniq_paths& files_paths)
 
     return result;
 }
+
+std::vector<paths> duplicates_scanner::analyse_small_group(size_t file_size,
+                                                           const uniq_paths& files_paths,
+                                                           paths& unfinished)
+{
+    std::unordered_map<size_t, paths> hashes;
+
+    for(auto iter = files_paths.begin(); iter != files_paths.end(); ++iter)
+    {
+        if(deadline_expired())
+        {
+            // непрочитанные файлы могут совпасть с любым уже прочитанным содержимым
+            unfinished.assign(iter, files_paths.end());
+            for(const auto& elem : hashes)
+                unfinished.push_back(elem.second.front());
+            break;
+        }
+
+        const bfs::path& p = *iter;
+        int fd = _dirs.open_file(p);
+        if(fd < 0)
+            continue;
+
+        _limiter->acquire(file_size);
+
+        ssize_t reading_result = 0;
+        do
+            reading_result = ::pread(fd, _small_files_arena.data(), file_size + 1, 0);
+        while(reading_result < 0 && errno == EINTR);
+
+        if(_cache_policy != cache_policy::normal)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+
+        // файл уменьшился или вырос после сканирования, либо не читается
+        if(reading_result < 0 || static_cast<size_t>(reading_result) != file_size)
+            continue;
+
+        hashes[_hash(_small_files_arena.data(), file_size)].push_back(p);
+    }
+
+    std::vector<paths> result;
+    for(auto& elem : hashes)
+        if(elem.second.size() > 1)
+            result.push_back(std::move(elem.second));
+
+    return result;
+}
@@ -2,10 +2,31 @@
 #define DUPLICATES_SCANNER_H
 
 #include "common_aliases.h"
+#include "block_reader.h"
+#include "dir_fd_cache.h"
+#include "group_scheduler.h"
+#include "rate_limiter.h"
 
+#include <chrono>
+#include <functional>
+#include <optional>
 #include <unordered_map>
 #include <set>
 
+/**
+ * @brief Структура содержащая результаты поиска дубликатов
+ */
+struct find_result {
+    /**
+     * @details Подтвержденные группы дубликатов
+     */
+    std::vector<paths> duplicates;
+    /**
+     * @details Группы кандидатов, проверка которых не завершилась до дедлайна
+     */
+    std::vector<paths> unfinished;
+};
+
 /**
  * @brief Класс, осуществляющий сравнение файлов одинакового размера
  */
@@ -13,28 +34,69 @@ class duplicates_scanner
 {
 public:
     using hash_function = std::function<std::size_t(char*, std::size_t)>;
+    using time_point = std::chrono::steady_clock::time_point;
 
     /**
      * @brief Конструктор
      * @arg block_size - размер блока для чтения
+     * @arg small_file_size - размер, до которого файл читается целиком за одно обращение
      * @arg hash_algo - название алгоритма хеширования
+     * @arg cache_policy - название политики работы со страничным кешем
+     * @arg limiter - ограничитель интенсивности чтения
+     * @arg order - название порядка обработки групп
+     * @arg deadline - момент, после которого поиск прекращается
      */
-    duplicates_scanner(std::optional<size_t> block_size, std::optional<std::string> hash_algo);
+    duplicates_scanner(std::optional<size_t> block_size,
+                       std::optional<size_t> small_file_size,
+                       std::optional<std::string> hash_algo,
+                       std::optional<std::string> cache_policy,
+                       std::shared_ptr<rate_limiter> limiter,
+                       std::optional<std::string> order,
+                       std::optional<time_point> deadline);
 
     /**
      * @brief Метод поиска дубликатов среди групп файлов одинакового размера
      * @arg files_paths - пути к файлам, сгруппированные по размеру
-     * @return Сгруппированные дубликаты
+     * @return Сгруппированные дубликаты и незавершенные к дедлайну группы
+     */
+    find_result find(const grouped_by_size& files_paths);
+
+    /**
+     * @brief Метод вычисления хеша всего содержимого файла
+     *  Используется для инкрементального поддержания индекса дубликатов
+     * @arg path - путь к файлу
+     * @return Хеш содержимого, либо ничего, если файл не удалось открыть
      */
-    std::vector<paths> find(const grouped_by_size& files_paths);
+    std::optional<size_t> digest(const bfs::path& path);
 
 private:
     /**
      * @brief Метод поиска дубликатов среди одной группы файлов одинакового размера
      * @arg files_paths - пути к файлам одного размера
-     * @return Вектор дубликатов
+     * @arg finished - признак того, что проверка группы не прервана дедлайном
+     * @return Вектор дубликатов, либо оставшиеся кандидаты при прерывании
+     */
+    paths analyse_group(const uniq_paths& files_paths, bool& finished);
+
+    /**
+     * @brief Метод проверки наступления дедлайна
+     * @return true, если время поиска истекло
+     */
+    bool deadline_expired() const;
+
+    /**
+     * @brief Метод поиска дубликатов среди группы маленьких файлов одинакового размера
+     *  Каждый файл читается целиком одним pread, хешируется один раз,
+     *  группировка по хешу выполняется за один проход
+     * @arg file_size - размер файлов группы
+     * @arg files_paths - пути к файлам одного размера
+     * @arg unfinished - при срабатывании дедлайна: непрочитанные файлы
+     *  и по одному представителю от каждого уже найденного содержимого
+     * @return Группы дубликатов среди прочитанных файлов
      */
-    paths analyse_group(const uniq_paths& files_paths);
+    std::vector<paths> analyse_small_group(size_t file_size,
+                                           const uniq_paths& files_paths,
+                                           paths& unfinished);
 
     /**
      * @brief Метод генерации функтора с хеш функцией
@@ -46,6 +108,17 @@ private:
 private:
     hash_function _hash;
     size_t _block_size;
+    size_t _zero_block_hash;
+    cache_policy _cache_policy;
+    std::unique_ptr<aligned_buffers_pool> _buffers;
+    std::shared_ptr<rate_limiter> _limiter;
+
+    size_t _small_file_size;
+    std::vector<char> _small_files_arena;
+    dir_fd_cache _dirs;
+
+    group_scheduler _scheduler;
+    std::optional<time_point> _deadline;
 };
 
 #endif // DUPLICATES_SCANNER_H
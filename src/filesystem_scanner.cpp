@@ -9,8 +9,10 @@ filesystem_scanner::filesystem_scanner(
         const paths &scanning_excluded,
         std::optional<size_t> scanning_level,
         std::optional<size_t> scanning_file_min_size,
-        std::vector<std::string> scanning_masks) :
-    _excluded(scanning_excluded)
+        std::vector<std::string> scanning_masks,
+        std::shared_ptr<rate_limiter> limiter) :
+    _excluded(scanning_excluded),
+    _limiter(limiter)
 {
     _dirs_f = create_dir_filters(scanning_level);
     _files_f = create_file_filters(scanning_file_min_size, scanning_masks);
@@ -18,14 +20,80 @@ filesystem_scanner::filesystem_scanner(
 
 grouped_by_size filesystem_scanner::scan(const paths &included)
 {
-    auto to_scan_paths = pre_check(included);
-    auto all_files = all_accepted_files(to_scan_paths);
+    auto all_files = scan_all(included);
 
     remove_uniq_sized_files(all_files);
 
     return all_files;
 }
 
+grouped_by_size filesystem_scanner::scan_all(const paths& included)
+{
+    std::vector<scan_dir> to_scan_dirs;
+    for(const auto& dir : pre_check(included))
+        to_scan_dirs.push_back(std::make_pair(dir, 0));
+
+    return all_accepted_files(to_scan_dirs);
+}
+
+grouped_by_size filesystem_scanner::scan_subtree(const scan_dir& root)
+{
+    return all_accepted_files({root});
+}
+
+void filesystem_scanner::set_dir_observer(dir_observer observer)
+{
+    _dir_observer = observer;
+}
+
+void filesystem_scanner::set_link_observer(link_observer observer)
+{
+    _link_observer = observer;
+}
+
+void filesystem_scanner::set_stop_predicate(stop_predicate stopped)
+{
+    _stopped = stopped;
+}
+
+bool filesystem_scanner::interrupted() const
+{
+    return _interrupted;
+}
+
+std::optional<bfs::path> filesystem_scanner::resolve_file(const bfs::path& path) const
+{
+    bsys::error_code error;
+    if(!bfs::is_regular_file(path, error))
+        return std::optional<bfs::path>();
+
+    bfs::file_status stat = bfs::symlink_status(path, error);
+    if(stat.type() != bfs::file_type::symlink_file)
+        return path;
+
+    bfs::path rel_path = bfs::read_symlink(path, error);
+    if(error)
+        return std::optional<bfs::path>();
+
+    bfs::path abs_path = bfs::canonical(rel_path, path.parent_path(), error);
+    if(error || !bfs::exists(abs_path, error))
+        return std::optional<bfs::path>();
+
+    return abs_path;
+}
+
+bool filesystem_scanner::accept_dir(const scan_dir& dir) const
+{
+    auto predicate = [&dir](const dir_filter& filter) {return filter(dir);};
+    return std::all_of(_dirs_f.begin(), _dirs_f.end(), predicate);
+}
+
+bool filesystem_scanner::accept_file(const bfs::path& path) const
+{
+    auto predicate = [&path](const file_filter& filter) {return filter(path);};
+    return std::all_of(_files_f.begin(), _files_f.end(), predicate);
+}
+
 paths filesystem_scanner::pre_check(const paths& included)
 {
     paths result;
@@ -56,16 +124,14 @@ paths filesystem_scanner::pre_check(const paths& included)
 void filesystem_scanner::handle_dir(std::queue<scan_dir> &result,
                                     const scan_dir dir)
 {
-    auto predicate = [dir](const dir_filter& filter) {return filter(dir);};
-    if(std::all_of(_dirs_f.begin(), _dirs_f.end(), predicate))
+    if(accept_dir(dir))
         result.push(dir);
 }
 
 void filesystem_scanner::handle_file(grouped_by_size& result,
                                      const bfs::path& path)
 {
-    auto predicate = [path](const file_filter& filter) {return filter(path);};
-    if(std::all_of(_files_f.begin(), _files_f.end(), predicate))
+    if(accept_file(path))
     {
         size_t size = bfs::file_size(path);
         auto found_iter = result.find(size);
@@ -90,13 +156,14 @@ void filesystem_scanner::remove_uniq_sized_files(grouped_by_size& files)
 }
 
 grouped_by_size filesystem_scanner::all_accepted_files(
-        const paths& included)
+        const std::vector<scan_dir>& included)
 {
     grouped_by_size result;
+    _interrupted = false;
 
     std::queue<scan_dir> to_scan_dirs;
     for(const auto& dir : included)
-        to_scan_dirs.push(std::make_pair(dir, 0));
+        to_scan_dirs.push(dir);
 
     while(!to_scan_dirs.empty())
     {
@@ -107,30 +174,37 @@ grouped_by_size filesystem_scanner::all_accepted_files(
         if(!bfs::exists(current_dir))
             continue;
 
+        _limiter->acquire(0);
         bsys::error_code error;
         bfs::directory_iterator it(current_dir, error);
         if(error.value() != bsys::errc::success)
             continue;
 
+        if(_dir_observer && !_dir_observer(current_scan_dir))
+            break;
+
         bfs::directory_iterator end;
         for(;it != end; ++it)
         {
+            // проверка на каждом элементе, так как одна директория может быть огромной
+            if(_stopped && _stopped())
+            {
+                _interrupted = true;
+                return result;
+            }
+
+            _limiter->acquire(0);
             if(bfs::is_directory(*it))
                 handle_dir(to_scan_dirs, std::make_pair(*it, current_scan_dir.second + 1));
-            else if(bfs::is_regular_file(*it))
+            else
             {
-                bfs::file_status stat = bfs::symlink_status(*it);
-                if(stat.type() == bfs::file_type::symlink_file)
-                {
-                    bfs::path rel_path = bfs::read_symlink(*it);
-                    bfs::path base_path = it->path().parent_path();
-                    bfs::path abs_path = bfs::canonical(rel_path, base_path);
-
-                    if(bfs::exists(abs_path))
-                        handle_file(result, abs_path);
-                }
-                else
-                    handle_file(result, *it);
+                auto file_path = resolve_file(*it);
+                if(!file_path.has_value())
+                    continue;
+
+                handle_file(result, file_path.value());
+                if(_link_observer && file_path.value() != it->path() && accept_file(file_path.value()))
+                    _link_observer(*it, file_path.value());
             }
         }
     }
@@ -3,8 +3,11 @@
 
 #include "common_aliases.h"
 #include "filters.h"
+#include "rate_limiter.h"
 
 #include <functional>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <set>
 
@@ -19,6 +22,9 @@ class filesystem_scanner
 public:
     using file_filters = std::vector<file_filter>;
     using dir_filters = std::vector<dir_filter>;
+    using dir_observer = std::function<bool(const scan_dir&)>;
+    using link_observer = std::function<void(const bfs::path&, const bfs::path&)>;
+    using stop_predicate = std::function<bool()>;
 
     /**
      * @brief Конструктор
@@ -26,11 +32,13 @@ public:
      * @arg scanning_level - глубина сканирования относительно заданных дирректорий
      * @arg scanning_file_min_size - минимальный размер файла, который подлежит рассмотрению
      * @arg scanning_masks - маски файлов
+     * @arg limiter - ограничитель интенсивности обращений к файловой системе
      */
     filesystem_scanner(const paths &scanning_excluded,
                        std::optional<size_t> scanning_level,
                        std::optional<size_t> scanning_file_min_size,
-                       std::vector<std::string> scanning_masks);
+                       std::vector<std::string> scanning_masks,
+                       std::shared_ptr<rate_limiter> limiter);
 
     /**
      * @brief Метод сканирования
@@ -39,6 +47,69 @@ public:
      */
     grouped_by_size scan(const paths& included);
 
+    /**
+     * @brief Метод сканирования без исключения файлов с уникальным размером
+     * @arg included - пути подлежащие сканированию
+     * @return Все подходящие по фильтрам файлы, сгруппированные по размеру
+     */
+    grouped_by_size scan_all(const paths& included);
+
+    /**
+     * @brief Метод сканирования поддерева без исключения файлов с уникальным размером
+     * @arg root - корень поддерева и его уровень относительно заданных директорий
+     * @return Все подходящие по фильтрам файлы, сгруппированные по размеру
+     */
+    grouped_by_size scan_subtree(const scan_dir& root);
+
+    /**
+     * @brief Метод установки наблюдателя за сканированием
+     * @arg observer - функтор, вызываемый для каждой открытой директории
+     *  до чтения ее содержимого, возврат false прерывает сканирование
+     */
+    void set_dir_observer(dir_observer observer);
+
+    /**
+     * @brief Метод установки наблюдателя за символическими ссылками
+     * @arg observer - функтор, вызываемый с путем ссылки и путем ее цели
+     *  для каждой ссылки, цель которой попала в результаты
+     */
+    void set_link_observer(link_observer observer);
+
+    /**
+     * @brief Метод установки условия досрочной остановки сканирования
+     * @arg stopped - функтор, при истинности которого обход прекращается
+     */
+    void set_stop_predicate(stop_predicate stopped);
+
+    /**
+     * @brief Метод проверки, было ли последнее сканирование остановлено досрочно
+     * @return Остановлено ли сканирование, результаты при этом неполные
+     */
+    bool interrupted() const;
+
+    /**
+     * @brief Метод получения пути, под которым файл попадает в результаты:
+     *  для символической ссылки это канонический путь к цели
+     * @arg path - путь к файлу
+     * @return Путь к обычному файлу, либо ничего, если это не обычный файл
+     *  или ссылка никуда не ведет
+     */
+    std::optional<bfs::path> resolve_file(const bfs::path& path) const;
+
+    /**
+     * @brief Метод проверки директории по фильтрам
+     * @arg dir - директория и ее уровень
+     * @return true, если директория подлежит сканированию
+     */
+    bool accept_dir(const scan_dir& dir) const;
+
+    /**
+     * @brief Метод проверки файла по фильтрам
+     * @arg path - путь к файлу
+     * @return true, если файл подлежит рассмотрению
+     */
+    bool accept_file(const bfs::path& path) const;
+
 private:
 
     /**
@@ -68,10 +139,10 @@ private:
     /**
      * @brief Метод осущесвляющий проход по файловой системе с целью
      *  поиска в заданных директориях фалов одинакового размера
-     * @arg included - директории для сканирования
+     * @arg included - директории для сканирования и их уровни
      * @return Список сгруппированных по размеру файлов
      */
-    grouped_by_size all_accepted_files(const paths& included);
+    grouped_by_size all_accepted_files(const std::vector<scan_dir>& included);
 
     /**
      * @brief Метод исключения из контейнера файлов с уникальным размером
@@ -103,6 +174,13 @@ private:
 
     dir_filters _dirs_f;
     file_filters _files_f;
+
+    dir_observer _dir_observer;
+    link_observer _link_observer;
+    stop_predicate _stopped;
+    bool _interrupted = false;
+
+    std::shared_ptr<rate_limiter> _limiter;
 };
 
 #endif // FILESYSTEM_SCANNER_H
@@ -0,0 +1,187 @@
+#include "filesystem_watcher.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    constexpr uint32_t watch_mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+            IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    constexpr uint32_t file_watch_mask = IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF;
+
+    bool is_link(const bfs::path& path)
+    {
+        boost::system::error_code error;
+        return bfs::symlink_status(path, error).type() == bfs::file_type::symlink_file;
+    }
+}
+
+filesystem_watcher::filesystem_watcher() :
+    _fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    if(_fd < 0)
+        throw std::runtime_error("can't initialize inotify");
+}
+
+filesystem_watcher::~filesystem_watcher()
+{
+    ::close(_fd);
+}
+
+int filesystem_watcher::fd() const
+{
+    return _fd;
+}
+
+bool filesystem_watcher::add_dir(const scan_dir& dir)
+{
+    int wd = inotify_add_watch(_fd, dir.first.c_str(), watch_mask);
+    if(wd < 0)
+        return false;
+
+    _dirs[wd] = dir;
+    return true;
+}
+
+bool filesystem_watcher::add_file(const bfs::path& file)
+{
+    int wd = inotify_add_watch(_fd, file.c_str(), file_watch_mask);
+    if(wd < 0)
+        return false;
+
+    _files[wd] = file;
+    return true;
+}
+
+void filesystem_watcher::remove_file(const bfs::path& file)
+{
+    for(auto iter = _files.begin(); iter != _files.end(); ++iter)
+        if(iter->second == file)
+        {
+            inotify_rm_watch(_fd, iter->first);
+            _files.erase(iter);
+            return;
+        }
+}
+
+bool filesystem_watcher::watches_dir(const bfs::path& dir) const
+{
+    for(const auto& elem : _dirs)
+        if(elem.second.first == dir)
+            return true;
+
+    return false;
+}
+
+std::vector<filesystem_watcher::event> filesystem_watcher::read_events()
+{
+    std::vector<event> result;
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    while(true)
+    {
+        ssize_t length = ::read(_fd, buffer, sizeof(buffer));
+        if(length <= 0)
+            break;
+
+        for(char* ptr = buffer; ptr < buffer + length;)
+        {
+            const auto* raw = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + raw->len;
+
+            // при переполнении ядро отбрасывает события, и восстановить
+            // по оставшимся событиям состояние дерева уже нельзя
+            if(raw->mask & IN_Q_OVERFLOW)
+            {
+                result.push_back({event::type::overflow, bfs::path(), 0});
+                continue;
+            }
+
+            auto file_iter = _files.find(raw->wd);
+            if(file_iter != _files.end())
+            {
+                if(raw->mask & IN_IGNORED)
+                    _files.erase(file_iter);
+                else if(raw->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                    result.push_back({event::type::file_removed, file_iter->second, 0});
+                else if(raw->mask & IN_CLOSE_WRITE)
+                    result.push_back({event::type::file_changed, file_iter->second, 0});
+                continue;
+            }
+
+            auto dir_iter = _dirs.find(raw->wd);
+            if(dir_iter == _dirs.end())
+                continue;
+
+            // директория удалена, ядро само снимает наблюдение
+            if(raw->mask & IN_IGNORED)
+            {
+                _dirs.erase(dir_iter);
+                continue;
+            }
+
+            if(raw->len == 0)
+                continue;
+
+            const scan_dir& parent = dir_iter->second;
+            bfs::path path = parent.first / raw->name;
+            bool is_dir = raw->mask & IN_ISDIR;
+
+            // перемещенная за пределы дерева директория продолжала бы
+            // присылать события со старыми путями
+            if(is_dir && (raw->mask & IN_MOVED_FROM))
+                remove_tree(path);
+
+            if(raw->mask & (IN_DELETE | IN_MOVED_FROM))
+                result.push_back({is_dir ? event::type::dir_removed : event::type::file_removed,
+                                  path, parent.second + 1});
+            else if(is_dir && (raw->mask & (IN_CREATE | IN_MOVED_TO)))
+                result.push_back({event::type::dir_added, path, parent.second + 1});
+            else if(!is_dir && (raw->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+                result.push_back({event::type::file_changed, path, parent.second + 1});
+            // у символической ссылки не бывает IN_CLOSE_WRITE,
+            // поэтому о ней сообщается сразу при создании
+            else if(!is_dir && (raw->mask & IN_CREATE) && is_link(path))
+                result.push_back({event::type::file_changed, path, parent.second + 1});
+        }
+    }
+
+    return result;
+}
+
+void filesystem_watcher::clear()
+{
+    for(const auto& dir : _dirs)
+        inotify_rm_watch(_fd, dir.first);
+
+    for(const auto& file : _files)
+        inotify_rm_watch(_fd, file.first);
+
+    _dirs.clear();
+    _files.clear();
+}
+
+void filesystem_watcher::remove_tree(const bfs::path& dir)
+{
+    std::string prefix = dir.string();
+    if(prefix.empty() || prefix.back() != bfs::path::preferred_separator)
+        prefix += bfs::path::preferred_separator;
+
+    auto iter = _dirs.begin();
+    while(iter != _dirs.end())
+    {
+        const bfs::path& watched = iter->second.first;
+        if(watched == dir || watched.string().compare(0, prefix.size(), prefix) == 0)
+        {
+            inotify_rm_watch(_fd, iter->first);
+            iter = _dirs.erase(iter);
+        }
+        else
+            ++iter;
+    }
+}
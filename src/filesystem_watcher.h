@@ -0,0 +1,127 @@
+#ifndef FILESYSTEM_WATCHER_H
+#define FILESYSTEM_WATCHER_H
+
+#include "common_aliases.h"
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Класс отслеживания изменений в директориях через inotify
+ */
+class filesystem_watcher
+{
+public:
+    /**
+     * @brief Событие файловой системы
+     */
+    struct event {
+        /**
+         * @brief Тип события
+         */
+        enum class type {
+            /**
+             * @details Файл записан, создан или перемещен в директорию
+             */
+            file_changed,
+            /**
+             * @details Файл удален или перемещен из директории
+             */
+            file_removed,
+            /**
+             * @details Директория создана или перемещена в отслеживаемую
+             */
+            dir_added,
+            /**
+             * @details Директория удалена или перемещена из отслеживаемой
+             */
+            dir_removed,
+            /**
+             * @details Очередь событий переполнена, часть событий потеряна
+             */
+            overflow
+        };
+
+        type kind;
+        /**
+         * @details Путь к файлу или директории
+         */
+        bfs::path path;
+        /**
+         * @details Уровень директории dir_added относительно заданных директорий
+         */
+        dir_rel_level level;
+    };
+
+    /**
+     * @brief Конструктор
+     */
+    filesystem_watcher();
+
+    /**
+     * @brief Деструктор
+     */
+    ~filesystem_watcher();
+
+    filesystem_watcher(const filesystem_watcher&) = delete;
+    filesystem_watcher& operator=(const filesystem_watcher&) = delete;
+
+    /**
+     * @brief Метод получения дескриптора для ожидания событий
+     * @return Дескриптор inotify
+     */
+    int fd() const;
+
+    /**
+     * @brief Метод добавления директории для отслеживания
+     * @arg dir - директория и ее уровень
+     * @return Удалось ли добавить директорию
+     */
+    bool add_dir(const scan_dir& dir);
+
+    /**
+     * @brief Метод добавления отдельного файла для отслеживания,
+     *  используется для целей ссылок, лежащих вне отслеживаемых директорий
+     * @arg file - путь к файлу
+     * @return Удалось ли добавить файл
+     */
+    bool add_file(const bfs::path& file);
+
+    /**
+     * @brief Метод снятия наблюдения с отдельного файла
+     * @arg file - путь к файлу
+     */
+    void remove_file(const bfs::path& file);
+
+    /**
+     * @brief Метод проверки, отслеживается ли директория
+     * @arg dir - путь к директории
+     * @return Отслеживается ли директория
+     */
+    bool watches_dir(const bfs::path& dir) const;
+
+    /**
+     * @brief Метод чтения накопившихся событий
+     * @return События в порядке поступления
+     */
+    std::vector<event> read_events();
+
+    /**
+     * @brief Метод снятия наблюдения со всех директорий
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Метод снятия наблюдения с директории и ее поддиректорий
+     * @arg dir - путь к директории
+     */
+    void remove_tree(const bfs::path& dir);
+
+private:
+    int _fd;
+    std::unordered_map<int, scan_dir> _dirs;
+    std::unordered_map<int, bfs::path> _files;
+};
+
+#endif // FILESYSTEM_WATCHER_H
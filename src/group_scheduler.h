@@ -0,0 +1,116 @@
+#ifndef GROUP_SCHEDULER_H
+#define GROUP_SCHEDULER_H
+
+#include "common_aliases.h"
+#include "rate_limiter.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * @brief Порядок обработки групп файлов одинакового размера
+ */
+enum class schedule_order {
+    /**
+     * @details Порядок хранения в контейнере
+     */
+    natural,
+    /**
+     * @details Сначала самые дорогие группы, для балансировки нагрузки
+     */
+    largest_first,
+    /**
+     * @details Сначала самые дешевые группы, для быстрого получения результатов
+     */
+    smallest_first
+};
+
+/**
+ * @brief Функция преобразования названия порядка обработки групп
+ * @arg order - название порядка
+ * @return Порядок обработки, по умолчанию natural
+ */
+schedule_order schedule_order_from_string(const std::optional<std::string>& order);
+
+/**
+ * @brief Группа файлов одинакового размера с оценкой стоимости обработки
+ */
+struct scheduled_group {
+    /**
+     * @details Размер файлов группы
+     */
+    size_t file_size;
+    /**
+     * @details Пути к файлам группы
+     */
+    const uniq_paths* files;
+    /**
+     * @details Оценка стоимости сравнения в байтах-эквивалентах
+     */
+    double cost;
+};
+
+/**
+ * @brief Класс, определяющий порядок обработки групп файлов
+ *  Стоимость группы оценивается как размер x количество файлов
+ *  с поправкой на тип устройства, на котором лежит первый файл группы
+ */
+class group_scheduler
+{
+public:
+    /**
+     * @brief Конструктор
+     * @arg order - порядок обработки групп
+     * @arg limiter - ограничитель интенсивности обращений к файловой системе
+     */
+    group_scheduler(schedule_order order, std::shared_ptr<rate_limiter> limiter);
+
+    /**
+     * @brief Метод построения очереди обработки групп
+     * @arg files - пути к файлам, сгруппированные по размеру
+     * @return Группы в порядке обработки
+     */
+    std::vector<scheduled_group> schedule(const grouped_by_size& files);
+
+private:
+    /**
+     * @brief Стоимость чтения с устройства
+     */
+    struct device_cost {
+        /**
+         * @details Множитель стоимости чтения одного байта
+         */
+        double byte_factor;
+        /**
+         * @details Накладные расходы на открытие и позиционирование в файле
+         */
+        double file_overhead;
+    };
+
+    /**
+     * @brief Метод оценки стоимости сравнения группы файлов
+     * @arg file_size - размер файлов группы
+     * @arg files - пути к файлам группы
+     * @return Оценка стоимости
+     */
+    double estimate(size_t file_size, const uniq_paths& files);
+
+    /**
+     * @brief Метод получения стоимости чтения с устройства
+     * @arg device - идентификатор устройства
+     * @return Стоимость чтения
+     */
+    device_cost cost_of(dev_t device);
+
+private:
+    schedule_order _order;
+    std::shared_ptr<rate_limiter> _limiter;
+    std::unordered_map<dev_t, device_cost> _devices;
+};
+
+#endif // GROUP_SCHEDULER_H
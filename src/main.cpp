@@ -1,7 +1,10 @@
 #include "arguments_parser.h"
+#include "chunks_scanner.h"
 #include "filesystem_scanner.h"
 #include "duplicates_scanner.h"
+#include "watch_service.h"
 
+#include <chrono>
 #include <iostream>
 
 /**
@@ -15,21 +18,91 @@
 
 int main (int argc, char** argv)
 {
+    auto start_time = std::chrono::steady_clock::now();
+
     arguments_parser args_parser;
     auto result = args_parser.parse(argc, argv);
     if(!result.has_value())
         return 0;
 
     auto res_value = result.value();
+    if(res_value.idle_priority && !rate_limiter::set_idle_priority())
+        std::cerr << "can't set idle priority" << std::endl;
+
+    auto limiter = std::make_shared<rate_limiter>(
+                res_value.limit_bytes_per_sec,
+                res_value.limit_iops,
+                res_value.limit_control_file);
+
     filesystem_scanner scanner(
                 res_value.scanning_excluded_paths,
                 res_value.scanning_level,
                 res_value.scanning_file_min_size,
-                res_value.scanning_masks);
-    auto files_to_check = scanner.scan(res_value.scanning_paths);
+                res_value.scanning_masks,
+                limiter);
+
+    if(res_value.chunking_avg_size.has_value())
+    {
+        chunks_scanner chunks(res_value.chunking_avg_size.value(),
+                              res_value.scanning_cache_policy,
+                              limiter);
+        auto report = chunks.scan(scanner.scan_all(res_value.scanning_paths));
+        for(const auto& pair : report.shared)
+        {
+            std::cout << pair.first << std::endl;
+            std::cout << pair.second << std::endl;
+            std::cout << "shared bytes: " << pair.shared_bytes << std::endl;
+            std::cout << std::endl;
+        }
+
+        std::cout << "total bytes: " << report.total_bytes << std::endl;
+        std::cout << "saved bytes: " << report.saved_bytes << std::endl;
+
+        if(report.untracked_owners > 0)
+            std::cout << "pairs may be incomplete: " << report.untracked_owners
+                      << " chunk occurrences exceed the limit of files per chunk" << std::endl;
+
+        if(!report.unreadable.empty())
+        {
+            std::cout << "unreadable files:" << std::endl << std::endl;
+            for(const auto& file : report.unreadable)
+                std::cout << file << std::endl;
+        }
+        return 0;
+    }
+
+    std::optional<duplicates_scanner::time_point> deadline;
+    if(res_value.scanning_deadline.has_value())
+        deadline = start_time + std::chrono::seconds(res_value.scanning_deadline.value());
 
-    duplicates_scanner files_scanner(res_value.scanning_block_size, res_value.scanning_hash_algo);
-    for(const auto& group : files_scanner.find(files_to_check))
+    duplicates_scanner files_scanner(res_value.scanning_block_size,
+                                     res_value.scanning_small_file_size,
+                                     res_value.scanning_hash_algo,
+                                     res_value.scanning_cache_policy,
+                                     limiter,
+                                     res_value.scanning_order,
+                                     deadline);
+
+    if(res_value.watch_socket.has_value())
+    {
+        try {
+            watch_service watcher(scanner, files_scanner, limiter, res_value.watch_socket.value());
+            watcher.run(res_value.scanning_paths);
+        }
+        catch(const std::runtime_error& ex) {
+            std::cerr << ex.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // обход дерева тоже укладывается в бюджет времени
+    if(deadline.has_value())
+        scanner.set_stop_predicate([&deadline]() {return std::chrono::steady_clock::now() >= deadline.value();});
+
+    auto files_to_check = scanner.scan(res_value.scanning_paths);
+    auto found = files_scanner.find(files_to_check);
+    for(const auto& group : found.duplicates)
     {
         for(const auto& file : group)
             std::cout << file << std::endl;
@@ -37,6 +110,21 @@ int main (int argc, char** argv)
         std::cout << std::endl;
     }
 
+    if(!found.unfinished.empty())
+    {
+        std::cout << "unfinished candidates:" << std::endl << std::endl;
+        for(const auto& group : found.unfinished)
+        {
+            for(const auto& file : group)
+                std::cout << file << std::endl;
+
+            std::cout << std::endl;
+        }
+    }
+
+    if(scanner.interrupted())
+        std::cout << "scan interrupted by deadline, not all files were checked" << std::endl;
+
     return 0;
 }
 
@@ -0,0 +1,82 @@
+#include "query_server.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+query_server::query_server(const bfs::path& socket_path) :
+    _fd(-1), _socket_path(socket_path)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    std::string path_str = _socket_path.string();
+    if(path_str.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("socket path is too long");
+    memcpy(address.sun_path, path_str.c_str(), path_str.size());
+
+    _fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(_fd < 0)
+        throw std::runtime_error("can't create socket");
+
+    // сокет мог остаться от предыдущего запуска
+    ::unlink(path_str.c_str());
+    if(::bind(_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(_fd, SOMAXCONN) != 0)
+    {
+        ::close(_fd);
+        throw std::runtime_error("can't listen on socket " + path_str);
+    }
+}
+
+query_server::~query_server()
+{
+    ::close(_fd);
+    ::unlink(_socket_path.c_str());
+}
+
+int query_server::fd() const
+{
+    return _fd;
+}
+
+void query_server::serve(const std::vector<paths>& groups)
+{
+    std::ostringstream stream;
+    for(const auto& group : groups)
+    {
+        for(const auto& file : group)
+            stream << file << std::endl;
+
+        stream << std::endl;
+    }
+    std::string answer = stream.str();
+
+    while(true)
+    {
+        int client = ::accept4(_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if(client < 0)
+            break;
+
+        // медленный клиент не должен надолго останавливать обработку событий
+        timeval timeout = {1, 0};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        size_t sent = 0;
+        while(sent < answer.size())
+        {
+            ssize_t result = ::send(client, answer.data() + sent, answer.size() - sent, MSG_NOSIGNAL);
+            if(result <= 0)
+                break;
+            sent += static_cast<size_t>(result);
+        }
+
+        ::close(client);
+    }
+}
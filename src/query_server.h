@@ -0,0 +1,47 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "common_aliases.h"
+
+#include <vector>
+
+/**
+ * @brief Класс локального сервера запросов на Unix сокете
+ *  Каждому подключившемуся клиенту отдается текущий список групп дубликатов
+ *  в том же формате, что и при обычном запуске, после чего соединение закрывается
+ */
+class query_server
+{
+public:
+    /**
+     * @brief Конструктор
+     * @arg socket_path - путь к сокету
+     */
+    explicit query_server(const bfs::path& socket_path);
+
+    /**
+     * @brief Деструктор, удаляет файл сокета
+     */
+    ~query_server();
+
+    query_server(const query_server&) = delete;
+    query_server& operator=(const query_server&) = delete;
+
+    /**
+     * @brief Метод получения дескриптора для ожидания подключений
+     * @return Дескриптор слушающего сокета
+     */
+    int fd() const;
+
+    /**
+     * @brief Метод обслуживания ожидающих клиентов
+     * @arg groups - текущие группы дубликатов
+     */
+    void serve(const std::vector<paths>& groups);
+
+private:
+    int _fd;
+    bfs::path _socket_path;
+};
+
+#endif // QUERY_SERVER_H
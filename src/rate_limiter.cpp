@@ -0,0 +1,131 @@
+#include "rate_limiter.h"
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    // емкость корзины - бюджет на 20 мс, чтобы не допускать всплесков
+    constexpr double burst_seconds = 0.02;
+
+    // долг отсыпается короткими шагами, чтобы новые лимиты
+    // из управляющего файла применялись без задержки
+    constexpr double sleep_step_seconds = 0.05;
+
+    // константы ioprio из linux/ioprio.h
+    constexpr int ioprio_who_process = 1;
+    constexpr int ioprio_class_idle = 3;
+    constexpr int ioprio_class_shift = 13;
+}
+
+volatile std::sig_atomic_t rate_limiter::_reload_requested = 0;
+
+rate_limiter::rate_limiter(std::optional<size_t> bytes_per_sec,
+                           std::optional<size_t> iops,
+                           std::optional<bfs::path> control_file) :
+    _last_refill(std::chrono::steady_clock::now()),
+    _control_file(control_file)
+{
+    set_limits(bytes_per_sec.value_or(0), iops.value_or(0));
+
+    if(_control_file.has_value())
+    {
+        reload();
+        std::signal(SIGHUP, &rate_limiter::on_reload_signal);
+    }
+}
+
+void rate_limiter::acquire(size_t bytes)
+{
+    check_reload();
+
+    if(_bytes.rate == 0 && _ops.rate == 0)
+        return;
+
+    double elapsed = refill_interval();
+    double wait = std::max(consume(_bytes, static_cast<double>(bytes), elapsed),
+                           consume(_ops, 1, elapsed));
+    while(wait > 0 && !(_stopped && _stopped()))
+    {
+        std::this_thread::sleep_for(
+                    std::chrono::duration<double>(std::min(wait, sleep_step_seconds)));
+        check_reload();
+
+        elapsed = refill_interval();
+        wait = std::max(consume(_bytes, 0, elapsed), consume(_ops, 0, elapsed));
+    }
+}
+
+void rate_limiter::set_limits(size_t bytes_per_sec, size_t iops)
+{
+    reset(_bytes, bytes_per_sec);
+    reset(_ops, iops);
+}
+
+void rate_limiter::set_stop_predicate(stop_predicate stopped)
+{
+    _stopped = stopped;
+}
+
+bool rate_limiter::set_idle_priority()
+{
+    int ioprio = ioprio_class_idle << ioprio_class_shift;
+    bool io_result = syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio) == 0;
+    bool cpu_result = setpriority(PRIO_PROCESS, 0, 19) == 0;
+    return io_result && cpu_result;
+}
+
+void rate_limiter::reset(token_bucket& bucket, size_t rate)
+{
+    bucket.rate = static_cast<double>(rate);
+    bucket.capacity = bucket.rate * burst_seconds;
+    // снятый лимит списывает долг, иначе он вернется при повторном включении
+    bucket.tokens = rate == 0 ? 0 : std::min(bucket.tokens, bucket.capacity);
+}
+
+double rate_limiter::consume(token_bucket& bucket, double amount, double elapsed)
+{
+    if(bucket.rate == 0)
+        return 0;
+
+    bucket.tokens = std::min(bucket.capacity, bucket.tokens + elapsed * bucket.rate);
+    bucket.tokens -= amount;
+
+    return bucket.tokens < 0 ? -bucket.tokens / bucket.rate : 0;
+}
+
+double rate_limiter::refill_interval()
+{
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - _last_refill).count();
+    _last_refill = now;
+    return elapsed;
+}
+
+void rate_limiter::check_reload()
+{
+    if(_reload_requested)
+    {
+        _reload_requested = 0;
+        reload();
+    }
+}
+
+void rate_limiter::reload()
+{
+    bfs::ifstream control(_control_file.value());
+    size_t bytes_per_sec = 0;
+    size_t iops = 0;
+    if(control >> bytes_per_sec >> iops)
+        set_limits(bytes_per_sec, iops);
+}
+
+void rate_limiter::on_reload_signal(int)
+{
+    _reload_requested = 1;
+}
@@ -0,0 +1,126 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include "common_aliases.h"
+
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <optional>
+
+/**
+ * @brief Класс ограничения интенсивности ввода-вывода
+ *  Ограничивает поток байт в секунду и количество операций в секунду
+ *  по алгоритму token bucket. Емкость корзин мала, поэтому запросы
+ *  распределяются равномерно, а не пачками.
+ *  Лимиты можно перечитать из управляющего файла по сигналу SIGHUP.
+ */
+class rate_limiter
+{
+public:
+    using stop_predicate = std::function<bool()>;
+
+    /**
+     * @brief Конструктор
+     * @arg bytes_per_sec - ограничение байт в секунду, 0 - без ограничения
+     * @arg iops - ограничение операций в секунду, 0 - без ограничения
+     * @arg control_file - файл с лимитами вида "<bytes_per_sec> <iops>",
+     *  перечитывается при получении SIGHUP
+     */
+    rate_limiter(std::optional<size_t> bytes_per_sec,
+                 std::optional<size_t> iops,
+                 std::optional<bfs::path> control_file);
+
+    /**
+     * @brief Метод ожидания разрешения на одну операцию ввода-вывода
+     * @arg bytes - объем операции в байтах
+     */
+    void acquire(size_t bytes);
+
+    /**
+     * @brief Метод изменения лимитов
+     * @arg bytes_per_sec - ограничение байт в секунду, 0 - без ограничения
+     * @arg iops - ограничение операций в секунду, 0 - без ограничения
+     */
+    void set_limits(size_t bytes_per_sec, size_t iops);
+
+    /**
+     * @brief Метод установки условия прерывания ожидания
+     * @arg stopped - функтор, при истинности которого ожидание прекращается
+     */
+    void set_stop_predicate(stop_predicate stopped);
+
+    /**
+     * @brief Метод перевода процесса в режим простоя:
+     *  idle класс планировщика ввода-вывода и минимальный приоритет CPU
+     * @return Удалось ли изменить приоритеты
+     */
+    static bool set_idle_priority();
+
+private:
+    /**
+     * @brief Корзина токенов
+     */
+    struct token_bucket {
+        /**
+         * @details Скорость пополнения в секунду, 0 - без ограничения
+         */
+        double rate = 0;
+        /**
+         * @details Емкость корзины
+         */
+        double capacity = 0;
+        /**
+         * @details Текущее количество токенов, может быть отрицательным
+         */
+        double tokens = 0;
+    };
+
+    /**
+     * @brief Метод настройки корзины на новую скорость
+     * @arg bucket - корзина
+     * @arg rate - скорость пополнения в секунду
+     */
+    static void reset(token_bucket& bucket, size_t rate);
+
+    /**
+     * @brief Метод списания токенов из корзины
+     * @arg bucket - корзина
+     * @arg amount - количество списываемых токенов
+     * @arg elapsed - время с предыдущего пополнения, секунды
+     * @return Время ожидания до погашения долга, секунды
+     */
+    static double consume(token_bucket& bucket, double amount, double elapsed);
+
+    /**
+     * @brief Метод получения времени с предыдущего пополнения корзин
+     * @return Время в секундах
+     */
+    double refill_interval();
+
+    /**
+     * @brief Метод перечитывания лимитов, если пришел SIGHUP
+     */
+    void check_reload();
+
+    /**
+     * @brief Метод чтения лимитов из управляющего файла
+     */
+    void reload();
+
+    /**
+     * @brief Обработчик сигнала перечитывания управляющего файла
+     */
+    static void on_reload_signal(int);
+
+private:
+    token_bucket _bytes;
+    token_bucket _ops;
+    std::chrono::steady_clock::time_point _last_refill;
+    std::optional<bfs::path> _control_file;
+    stop_predicate _stopped;
+
+    static volatile std::sig_atomic_t _reload_requested;
+};
+
+#endif // RATE_LIMITER_H
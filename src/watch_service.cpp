@@ -0,0 +1,189 @@
+#include "watch_service.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <iostream>
+
+#include <poll.h>
+
+volatile std::sig_atomic_t watch_service::_stop_requested = 0;
+
+watch_service::watch_service(filesystem_scanner& fs_scanner,
+                             duplicates_scanner& files_scanner,
+                             std::shared_ptr<rate_limiter> limiter,
+                             const bfs::path& socket_path) :
+    _fs_scanner(fs_scanner),
+    _index(files_scanner, [](){return _stop_requested != 0;}),
+    _server(socket_path)
+{
+    _fs_scanner.set_dir_observer([this](const scan_dir& dir) {return watch_dir(dir);});
+    _fs_scanner.set_link_observer([this](const bfs::path& link, const bfs::path& target)
+    {add_link(link, target);});
+    // иначе при жестком лимите сигнал остановки ждал бы погашения всего долга
+    limiter->set_stop_predicate([](){return _stop_requested != 0;});
+}
+
+void watch_service::run(const paths& included)
+{
+    std::signal(SIGINT, &watch_service::on_stop_signal);
+    std::signal(SIGTERM, &watch_service::on_stop_signal);
+
+    // наблюдение ставится на директорию до чтения ее содержимого,
+    // поэтому изменения во время первого прохода не теряются
+    _included = included;
+    rebuild();
+
+    pollfd fds[2] = {{_watcher.fd(), POLLIN, 0}, {_server.fd(), POLLIN, 0}};
+    while(!_stop_requested)
+    {
+        if(::poll(fds, 2, -1) < 0)
+            continue;
+
+        if(fds[0].revents & POLLIN)
+            for(const auto& ev : _watcher.read_events())
+            {
+                // после потери событий индекс строится заново,
+                // остальные события пачки уже учтены полным проходом
+                if(ev.kind == filesystem_watcher::event::type::overflow)
+                {
+                    rebuild();
+                    break;
+                }
+
+                handle_event(ev);
+            }
+
+        if(fds[1].revents & POLLIN)
+            _server.serve(_index.duplicates());
+    }
+}
+
+void watch_service::rebuild()
+{
+    _watcher.clear();
+    _index.clear();
+    _links.clear();
+
+    auto files = _fs_scanner.scan_all(_included);
+    _index.add(files);
+}
+
+bool watch_service::watch_dir(const scan_dir& dir)
+{
+    if(!_watcher.add_dir(dir))
+        std::cerr << "can't watch directory " << dir.first << std::endl;
+
+    return !_stop_requested;
+}
+
+void watch_service::add_link(const bfs::path& link, const bfs::path& target)
+{
+    _links[link] = target;
+    if(!_watcher.watches_dir(target.parent_path()) && !_watcher.add_file(target))
+        std::cerr << "can't watch file " << target << std::endl;
+}
+
+void watch_service::remove_link(const bfs::path& link)
+{
+    auto iter = _links.find(link);
+    if(iter == _links.end())
+        return;
+
+    bfs::path target = iter->second;
+    _links.erase(iter);
+
+    // цель внутри дерева остается в индексе как обычный файл
+    if(_watcher.watches_dir(target.parent_path()))
+        return;
+
+    for(const auto& elem : _links)
+        if(elem.second == target)
+            return;
+
+    _watcher.remove_file(target);
+    _index.remove(target);
+}
+
+void watch_service::remove_links_tree(const bfs::path& dir)
+{
+    std::string prefix = dir.string();
+    if(prefix.empty() || prefix.back() != bfs::path::preferred_separator)
+        prefix += bfs::path::preferred_separator;
+
+    paths removed;
+    for(auto iter = _links.lower_bound(dir);
+        iter != _links.end() && iter->first.string().compare(0, prefix.size(), prefix) == 0; ++iter)
+        removed.push_back(iter->first);
+
+    for(const bfs::path& link : removed)
+        remove_link(link);
+}
+
+void watch_service::handle_event(const filesystem_watcher::event& ev)
+{
+    switch(ev.kind)
+    {
+    case filesystem_watcher::event::type::file_changed:
+        handle_changed_file(ev.path);
+        break;
+
+    case filesystem_watcher::event::type::file_removed:
+        remove_link(ev.path);
+        _index.remove(ev.path);
+        break;
+
+    case filesystem_watcher::event::type::dir_added:
+    {
+        scan_dir dir = std::make_pair(ev.path, ev.level);
+        if(!_fs_scanner.accept_dir(dir))
+            break;
+
+        _index.add(_fs_scanner.scan_subtree(dir));
+        break;
+    }
+
+    case filesystem_watcher::event::type::dir_removed:
+        remove_links_tree(ev.path);
+        _index.remove_tree(ev.path);
+        break;
+
+    case filesystem_watcher::event::type::overflow:
+        rebuild();
+        break;
+    }
+}
+
+void watch_service::handle_changed_file(const bfs::path& path)
+{
+    // файл может исчезнуть или измениться в любой момент между событием и обработкой
+    try
+    {
+        // ссылки попадают в индекс так же, как при сканировании: путем цели
+        auto file_path = _fs_scanner.resolve_file(path);
+
+        // ссылка могла смениться обычным файлом или начать вести в другое место
+        auto link_iter = _links.find(path);
+        if(link_iter != _links.end() && (!file_path.has_value() || link_iter->second != file_path.value()))
+            remove_link(path);
+
+        if(file_path.has_value() && _fs_scanner.accept_file(file_path.value()))
+        {
+            if(file_path.value() != path)
+                add_link(path, file_path.value());
+
+            _index.update(file_path.value(), bfs::file_size(file_path.value()));
+        }
+        else
+            _index.remove(path);
+    }
+    catch(const bfs::filesystem_error&)
+    {
+        remove_link(path);
+        _index.remove(path);
+    }
+}
+
+void watch_service::on_stop_signal(int)
+{
+    _stop_requested = 1;
+}
@@ -0,0 +1,107 @@
+#ifndef WATCH_SERVICE_H
+#define WATCH_SERVICE_H
+
+#include "common_aliases.h"
+#include "duplicates_index.h"
+#include "duplicates_scanner.h"
+#include "filesystem_scanner.h"
+#include "filesystem_watcher.h"
+#include "query_server.h"
+#include "rate_limiter.h"
+
+#include <csignal>
+#include <map>
+#include <memory>
+
+/**
+ * @brief Класс непрерывного отслеживания дубликатов
+ *  После одного полного прохода поддерживает индекс дубликатов
+ *  по событиям inotify и отвечает на запросы через Unix сокет
+ */
+class watch_service
+{
+public:
+    /**
+     * @brief Конструктор
+     * @arg fs_scanner - объект сканирования файловой системы
+     * @arg files_scanner - объект вычисления хешей содержимого
+     * @arg limiter - общий ограничитель ввода-вывода
+     * @arg socket_path - путь к сокету для запросов
+     */
+    watch_service(filesystem_scanner& fs_scanner,
+                  duplicates_scanner& files_scanner,
+                  std::shared_ptr<rate_limiter> limiter,
+                  const bfs::path& socket_path);
+
+    /**
+     * @brief Метод запуска отслеживания, работает до SIGINT или SIGTERM
+     * @arg included - пути подлежащие сканированию
+     */
+    void run(const paths& included);
+
+private:
+    /**
+     * @brief Метод полного прохода: заново строит индекс и наблюдение за директориями
+     */
+    void rebuild();
+
+    /**
+     * @brief Метод добавления наблюдения за директорией, вызывается при сканировании
+     * @arg dir - директория и ее уровень
+     * @return Продолжать ли сканирование
+     */
+    bool watch_dir(const scan_dir& dir);
+
+    /**
+     * @brief Метод запоминания ссылки, цель которой попала в индекс.
+     *  Цель вне отслеживаемых директорий отслеживается отдельно
+     * @arg link - путь к ссылке
+     * @arg target - канонический путь к цели
+     */
+    void add_link(const bfs::path& link, const bfs::path& target);
+
+    /**
+     * @brief Метод забывания ссылки: цель удаляется из индекса,
+     *  если она вне отслеживаемых директорий и на нее не ведут другие ссылки
+     * @arg link - путь к ссылке
+     */
+    void remove_link(const bfs::path& link);
+
+    /**
+     * @brief Метод забывания всех ссылок директории и ее поддиректорий
+     * @arg dir - путь к директории
+     */
+    void remove_links_tree(const bfs::path& dir);
+
+    /**
+     * @brief Метод обработки события файловой системы
+     * @arg ev - событие
+     */
+    void handle_event(const filesystem_watcher::event& ev);
+
+    /**
+     * @brief Метод обновления изменившегося файла в индексе
+     * @arg path - путь к файлу
+     */
+    void handle_changed_file(const bfs::path& path);
+
+    /**
+     * @brief Обработчик сигналов завершения
+     */
+    static void on_stop_signal(int);
+
+private:
+    filesystem_scanner& _fs_scanner;
+    paths _included;
+    duplicates_index _index;
+    filesystem_watcher _watcher;
+    query_server _server;
+    /**
+     * @details Ссылки и их цели, под путями целей файлы лежат в индексе
+     */
+    std::map<bfs::path, bfs::path> _links;
+
+    static volatile std::sig_atomic_t _stop_requested;
+};
+
+#endif // WATCH_SERVICE_H
@@ -1,7 +1,395 @@
 
 #include <gtest/gtest.h>
 
+#include "chunker.h"
+#include "block_reader.h"
+#include "chunks_scanner.h"
+#include "duplicates_index.h"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    constexpr size_t avg_chunk_size = 4096;
+
+    std::string make_random_data(size_t size, unsigned seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dist(0, 255);
+
+        std::string result(size, '\0');
+        for(char& c : result)
+            c = static_cast<char>(dist(gen));
+
+        return result;
+    }
+
+    std::vector<std::string> split(const std::string& data, const std::vector<size_t>& portions)
+    {
+        std::vector<std::string> result;
+        auto handler = [&result](std::string_view chunk) {result.emplace_back(chunk);};
+
+        chunker splitter(avg_chunk_size);
+        size_t offset = 0;
+        for(size_t portion : portions)
+        {
+            splitter.feed(data.data() + offset, portion, handler);
+            offset += portion;
+        }
+        splitter.feed(data.data() + offset, data.size() - offset, handler);
+        splitter.finish(handler);
+
+        return result;
+    }
+
+    void write_file(const bfs::path& path, const std::string& content)
+    {
+        bfs::create_directories(path.parent_path());
+        bfs::ofstream file(path);
+        file << content;
+    }
+
+    // файл заданного размера, где данные записаны только по смещению offset,
+    // а остальное - дыры, как после truncate
+    void write_sparse_file(const bfs::path& path, size_t size, size_t offset, const std::string& data)
+    {
+        bfs::create_directories(path.parent_path());
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ASSERT_GE(fd, 0);
+        ASSERT_EQ(::ftruncate(fd, static_cast<off_t>(size)), 0);
+        ASSERT_EQ(::pwrite(fd, data.data(), data.size(), static_cast<off_t>(offset)),
+                  static_cast<ssize_t>(data.size()));
+        ::close(fd);
+    }
+
+    find_result find_duplicates(const paths& files)
+    {
+        grouped_by_size grouped;
+        for(const bfs::path& p : files)
+            grouped[bfs::file_size(p)].insert(p);
+
+        auto limiter = std::make_shared<rate_limiter>(std::nullopt, std::nullopt, std::nullopt);
+        duplicates_scanner scanner(std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+                                   limiter, std::nullopt, std::nullopt);
+        find_result result = scanner.find(grouped);
+        for(paths& group : result.duplicates)
+            std::sort(group.begin(), group.end());
+        std::sort(result.duplicates.begin(), result.duplicates.end());
+
+        return result;
+    }
+}
+
 TEST(FOO, BAR)
 {
 }
 
+TEST(CHUNKER, RANDOM_PORTIONS_GIVE_SAME_CHUNKS)
+{
+    const std::string data = make_random_data(1024 * 1024, 1);
+    const std::vector<std::string> expected = split(data, {});
+
+    std::mt19937 gen(2);
+    for(int attempt = 0; attempt < 20; ++attempt)
+    {
+        std::uniform_int_distribution<size_t> dist(0, 3 * avg_chunk_size);
+        std::vector<size_t> portions;
+        size_t total = 0;
+        while(true)
+        {
+            size_t portion = dist(gen);
+            if(total + portion > data.size())
+                break;
+
+            portions.push_back(portion);
+            total += portion;
+        }
+
+        ASSERT_EQ(split(data, portions), expected);
+    }
+}
+
+TEST(CHUNKER, CHUNK_SIZE_BOUNDS)
+{
+    const size_t min_size = avg_chunk_size / 4;
+    const size_t max_size = avg_chunk_size * 8;
+
+    // нули не дают границ по содержимому, поэтому проверяется и верхняя граница
+    std::string data = make_random_data(1024 * 1024, 3) + std::string(1024 * 1024, '\0');
+    std::vector<std::string> chunks = split(data, {});
+    ASSERT_FALSE(chunks.empty());
+
+    size_t total = 0;
+    for(size_t i = 0; i < chunks.size(); ++i)
+    {
+        total += chunks[i].size();
+        EXPECT_LE(chunks[i].size(), max_size);
+        // последний блок может быть короче минимального
+        if(i + 1 < chunks.size())
+        {
+            EXPECT_GE(chunks[i].size(), min_size);
+        }
+    }
+    EXPECT_EQ(total, data.size());
+}
+
+TEST(DUPLICATES_INDEX, REMOVE_TREE_KEEPS_SIBLINGS)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    bfs::path dir = root / "dir";
+
+    // "dir-c" при посимвольном сравнении оказался бы между "dir" и "dir/x"
+    paths files = {dir / "x", dir / "sub" / "w", root / "dir_other" / "y", root / "dir-c" / "z"};
+    grouped_by_size grouped;
+    for(const bfs::path& p : files)
+    {
+        write_file(p, "same");
+        grouped[4].insert(p);
+    }
+
+    auto limiter = std::make_shared<rate_limiter>(std::nullopt, std::nullopt, std::nullopt);
+    duplicates_scanner scanner(std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+                               limiter, std::nullopt, std::nullopt);
+    duplicates_index index(scanner, [](){return false;});
+    index.add(grouped);
+
+    index.remove_tree(dir);
+    std::vector<paths> groups = index.duplicates();
+
+    bfs::remove_all(root);
+
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0], (paths{root / "dir-c" / "z", root / "dir_other" / "y"}));
+}
+
+TEST(CHUNKS_SCANNER, REPEATED_CHUNKS_DO_NOT_EXCEED_SMALLER_FILE)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+
+    // второй файл - первый, повторенный 50 раз
+    const std::string block = make_random_data(64 * 1024, 4);
+    std::string repeated;
+    for(int i = 0; i < 50; ++i)
+        repeated += block;
+
+    write_file(root / "a", block);
+    write_file(root / "b", repeated);
+
+    grouped_by_size grouped;
+    grouped[block.size()].insert(root / "a");
+    grouped[repeated.size()].insert(root / "b");
+
+    auto limiter = std::make_shared<rate_limiter>(std::nullopt, std::nullopt, std::nullopt);
+    chunks_scanner scanner(avg_chunk_size, std::nullopt, limiter);
+    chunks_report report = scanner.scan(grouped);
+
+    bfs::remove_all(root);
+
+    ASSERT_EQ(report.shared.size(), 1u);
+    EXPECT_GT(report.shared[0].shared_bytes, 0u);
+    EXPECT_LE(report.shared[0].shared_bytes, block.size());
+    EXPECT_EQ(report.total_bytes, block.size() + repeated.size());
+    EXPECT_TRUE(report.unreadable.empty());
+}
+
+TEST(CHUNKS_SCANNER, UNREADABLE_FILE_IS_NOT_COUNTED)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    const std::string data = make_random_data(64 * 1024, 5);
+    write_file(root / "a", data);
+    write_file(root / "b", data);
+
+    // директория открывается на чтение, но read для нее завершается ошибкой
+    bfs::create_directories(root / "dir");
+
+    grouped_by_size grouped;
+    grouped[data.size()] = {root / "a", root / "b", root / "dir"};
+
+    auto limiter = std::make_shared<rate_limiter>(std::nullopt, std::nullopt, std::nullopt);
+    chunks_scanner scanner(avg_chunk_size, std::nullopt, limiter);
+    chunks_report report = scanner.scan(grouped);
+
+    bfs::remove_all(root);
+
+    ASSERT_EQ(report.unreadable, (paths{root / "dir"}));
+    ASSERT_EQ(report.shared.size(), 1u);
+    EXPECT_EQ(report.shared[0].shared_bytes, data.size());
+    EXPECT_EQ(report.total_bytes, 2 * data.size());
+}
+
+TEST(SPARSE_FILES, SPARSE_AND_DENSE_WITH_SAME_BYTES_ARE_DUPLICATES)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    const size_t size = 1024 * 1024;
+    const size_t offset = 512 * 1024;
+    const std::string data = make_random_data(8192, 6);
+
+    write_sparse_file(root / "sparse", size, offset, data);
+
+    std::string dense(size, '\0');
+    dense.replace(offset, data.size(), data);
+    write_file(root / "dense", dense);
+
+    // начало разреженного файла - дыра, которая не читается с диска
+    bool starts_with_hole = block_reader(root / "sparse", 4096, cache_policy::normal).next_is_hole();
+    find_result result = find_duplicates({root / "sparse", root / "dense"});
+
+    bfs::remove_all(root);
+
+    EXPECT_TRUE(starts_with_hole);
+    EXPECT_EQ(result.duplicates, (std::vector<paths>{{root / "dense", root / "sparse"}}));
+    EXPECT_TRUE(result.unfinished.empty());
+}
+
+TEST(SPARSE_FILES, DIFFERENCE_IN_DATA_AFTER_HOLE_IS_FOUND)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    const size_t size = 1024 * 1024;
+    const size_t offset = 512 * 1024;
+    std::string data = make_random_data(8192, 7);
+
+    write_sparse_file(root / "a", size, offset, data);
+    // отличие в середине блока, а не на его границе
+    data[5000] = static_cast<char>(data[5000] ^ 1);
+    write_sparse_file(root / "b", size, offset, data);
+
+    find_result result = find_duplicates({root / "a", root / "b"});
+
+    bfs::remove_all(root);
+
+    EXPECT_TRUE(result.duplicates.empty());
+}
+
+TEST(SPARSE_FILES, LAST_PARTIAL_BLOCK_IN_HOLE)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    const size_t block_size = 4096;
+    const size_t tail = 1000;
+    const size_t size = 16 * block_size + tail;
+    const std::string data = make_random_data(block_size, 8);
+
+    // данные только в первом блоке, конец файла вместе с неполным блоком - дыра
+    write_sparse_file(root / "sparse", size, 0, data);
+    std::string dense(size, '\0');
+    dense.replace(0, data.size(), data);
+    write_file(root / "dense", dense);
+
+    std::vector<char> buffer(block_size);
+    size_t total = 0;
+    ssize_t last = 0;
+    bool last_is_hole = false;
+    {
+        block_reader reader(root / "sparse", block_size, cache_policy::normal);
+        ASSERT_TRUE(reader.is_open());
+        ssize_t reading_result = 0;
+        while(true)
+        {
+            bool hole = reader.next_is_hole();
+            reading_result = reader.read(buffer.data());
+            if(reading_result <= 0)
+                break;
+
+            total += static_cast<size_t>(reading_result);
+            last = reading_result;
+            last_is_hole = hole;
+        }
+        EXPECT_EQ(reading_result, 0);
+    }
+
+    find_result result = find_duplicates({root / "sparse", root / "dense"});
+
+    bfs::remove_all(root);
+
+    EXPECT_EQ(total, size);
+    EXPECT_EQ(last, static_cast<ssize_t>(tail));
+    EXPECT_TRUE(last_is_hole);
+    EXPECT_TRUE(std::all_of(buffer.begin(), buffer.begin() + tail, [](char c) {return c == 0;}));
+    EXPECT_EQ(result.duplicates, (std::vector<paths>{{root / "dense", root / "sparse"}}));
+}
+
+TEST(BLOCK_READER, READ_ERROR_IS_NOT_EOF)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    const size_t block_size = 4096;
+    write_file(root / "file", make_random_data(block_size + 10, 9));
+    bfs::create_directories(root / "dir");
+
+    std::vector<char> buffer(block_size);
+
+    block_reader file_reader(root / "file", block_size, cache_policy::normal);
+    EXPECT_EQ(file_reader.read(buffer.data()), static_cast<ssize_t>(block_size));
+    EXPECT_EQ(file_reader.read(buffer.data()), 10);
+    EXPECT_EQ(file_reader.read(buffer.data()), 0);
+
+    block_reader missing_reader(root / "missing", block_size, cache_policy::normal);
+    EXPECT_FALSE(missing_reader.is_open());
+    EXPECT_EQ(missing_reader.read(buffer.data()), -1);
+
+    // директория открывается, но read для нее завершается ошибкой EISDIR
+    block_reader dir_reader(root / "dir", block_size, cache_policy::normal);
+    EXPECT_EQ(dir_reader.read(buffer.data()), -1);
+
+    bfs::remove_all(root);
+}
+
+TEST(BLOCK_READER, UNREADABLE_FILE_IS_DROPPED_FROM_GROUP)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    const std::string data = make_random_data(64 * 1024, 10);
+    write_file(root / "a", data);
+    write_file(root / "b", data);
+    bfs::create_directories(root / "dir");
+
+    grouped_by_size grouped;
+    grouped[data.size()] = {root / "a", root / "b", root / "dir"};
+
+    auto limiter = std::make_shared<rate_limiter>(std::nullopt, std::nullopt, std::nullopt);
+    duplicates_scanner scanner(std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+                               limiter, std::nullopt, std::nullopt);
+    find_result result = scanner.find(grouped);
+
+    bfs::remove_all(root);
+
+    ASSERT_EQ(result.duplicates.size(), 1u);
+    std::sort(result.duplicates[0].begin(), result.duplicates[0].end());
+    EXPECT_EQ(result.duplicates[0], (paths{root / "a", root / "b"}));
+}
+
+TEST(SMALL_FILES, GROUP_IS_SPLIT_BY_HASH)
+{
+    bfs::path root = bfs::temp_directory_path() / bfs::unique_path();
+    write_file(root / "a1", "aaaa");
+    write_file(root / "d1" / "a2", "aaaa");
+    write_file(root / "b1", "bbbb");
+    write_file(root / "d2" / "b2", "bbbb");
+    write_file(root / "c", "cccc");
+    // файл вырос после сканирования, его начало совпадает с "a"
+    write_file(root / "grown", "aaaax");
+
+    grouped_by_size grouped;
+    grouped[4] = {root / "a1", root / "d1" / "a2", root / "b1",
+                  root / "d2" / "b2", root / "c", root / "grown"};
+
+    auto limiter = std::make_shared<rate_limiter>(std::nullopt, std::nullopt, std::nullopt);
+    duplicates_scanner scanner(std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+                               limiter, std::nullopt, std::nullopt);
+    find_result result = scanner.find(grouped);
+
+    bfs::remove_all(root);
+
+    for(paths& group : result.duplicates)
+        std::sort(group.begin(), group.end());
+    std::sort(result.duplicates.begin(), result.duplicates.end());
+
+    EXPECT_EQ(result.duplicates, (std::vector<paths>{{root / "a1", root / "d1" / "a2"},
+                                                     {root / "b1", root / "d2" / "b2"}}));
+    EXPECT_TRUE(result.unfinished.empty());
+}